@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <drivers/edc.h>
+#include <system/checksum.h>
+
+/*
+ * Cost of the checksum module against the bit by bit CRC-8 and bytewise
+ * XOR loops the drivers used before, on the sizes they see: 8 byte TTC 2.0
+ * register frames, 224 byte TTC 2.0 packets and the 8200 byte EDC ADC
+ * frame. Both versions are checked to agree first.
+ */
+
+#define BYTES_PER_SIZE (256UL * 1024UL * 1024UL)
+
+static volatile uint32_t sink;
+
+static uint8_t crc8_bitwise(const uint8_t *data, size_t len)
+{
+	uint8_t crc = 0U;
+
+	for (size_t i = 0U; i < len; i++) {
+		crc ^= data[i];
+
+		for (uint8_t j = 0U; j < 8U; j++)
+			crc = (crc << 1) ^ ((crc & 0x80U) ? 0x07U : 0U);
+	}
+
+	return crc;
+}
+
+static uint8_t xor_bytewise(const uint8_t *data, size_t len)
+{
+	uint8_t sum = 0U;
+
+	for (size_t i = 0U; i < len; i++)
+		sum ^= data[i];
+
+	return sum;
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static void run(const char *name, uint8_t (*fn)(const uint8_t *, size_t),
+		uint8_t *buf, size_t len)
+{
+	unsigned long rounds = BYTES_PER_SIZE / len;
+	uint32_t acc = 0U;
+	double start = now_ns();
+
+	for (unsigned long i = 0UL; i < rounds; ++i) {
+		buf[i % len] = (uint8_t)i;
+		acc += fn(buf, len);
+	}
+
+	double ns = now_ns() - start;
+
+	printf("%-16s %5zu bytes %8.1f ns/buffer %7.1f MB/s\n", name, len,
+	       ns / (double)rounds, ((double)BYTES_PER_SIZE * 1e3) / ns);
+
+	sink = acc;
+}
+
+int main(void)
+{
+	static uint8_t buf[EDC_FRAME_ADC_SEQ_LEN];
+	static const size_t sizes[] = { 8U, 224U, EDC_FRAME_ADC_SEQ_LEN };
+	uint32_t x = 1U;
+
+	for (size_t i = 0U; i < sizeof(buf); ++i) {
+		x = (x * 1103515245U) + 12345U;
+		buf[i] = (uint8_t)(x >> 16);
+	}
+
+	for (size_t len = 0U; len <= 64U; ++len) {
+		uint8_t part = checksum_crc8_update(CHECKSUM_CRC8_INIT, buf,
+						    len / 3U);
+
+		if ((checksum_crc8(buf, len) != crc8_bitwise(buf, len)) ||
+		    (checksum_crc8_update(part, &buf[len / 3U],
+					  len - (len / 3U)) !=
+		     crc8_bitwise(buf, len)) ||
+		    (checksum_xor8(&buf[len % 7U], len) !=
+		     xor_bytewise(&buf[len % 7U], len))) {
+			fprintf(stderr, "Mismatch at length %zu\n", len);
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (size_t i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); ++i) {
+		run("crc8, bitwise", crc8_bitwise, buf, sizes[i]);
+		run("crc8, table", checksum_crc8, buf, sizes[i]);
+		run("xor, bytewise", xor_bytewise, buf, sizes[i]);
+		run("xor, words", checksum_xor8, buf, sizes[i]);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <drivers/sl_eps2.h>
+#include <drivers/sl_ttc2.h>
+
+/*
+ * Cost of the register codecs of the TTC 2.0 and EPS 2.0 drivers. The
+ * "switch" rows run the per-register switch and range checks the drivers
+ * used before the register descriptor tables, the "table" rows the current
+ * codecs. The addresses follow a fixed pseudo-random order, so the branches
+ * of the switch can't just be learnt.
+ */
+
+#define ITERATIONS 20000000UL
+
+static volatile uint32_t sink;
+
+static void ttc_encode_switch(uint8_t adr, uint32_t val, uint8_t *buf)
+{
+	switch (adr) {
+	case SL_TTC2_REG_DEVICE_ID:
+	case SL_TTC2_REG_RESET_COUNTER:
+	case SL_TTC2_REG_INPUT_VOLTAGE_MCU:
+	case SL_TTC2_REG_INPUT_CURRENT_MCU:
+	case SL_TTC2_REG_TEMPERATURE_MCU:
+	case SL_TTC2_REG_INPUT_VOLTAGE_RADIO:
+	case SL_TTC2_REG_INPUT_CURRENT_RADIO:
+	case SL_TTC2_REG_TEMPERATURE_RADIO:
+	case SL_TTC2_REG_RSSI_LAST_VALID_TC:
+	case SL_TTC2_REG_TEMPERATURE_ANTENNA:
+	case SL_TTC2_REG_ANTENNA_STATUS:
+	case SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO:
+		buf[0] = (val >> 8) & 0xFFU;
+		buf[1] = (val >> 0) & 0xFFU;
+		break;
+	case SL_TTC2_REG_HARDWARE_VERSION:
+	case SL_TTC2_REG_LAST_RESET_CAUSE:
+	case SL_TTC2_REG_LAST_VALID_TC:
+	case SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS:
+	case SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS:
+	case SL_TTC2_REG_TX_ENABLE:
+	case SL_TTC2_REG_FIFO_TX_PACKET:
+	case SL_TTC2_REG_FIFO_RX_PACKET:
+	case SL_TTC2_REG_RESET_DEVICE:
+		buf[0] = val & 0xFFU;
+		break;
+	default:
+		buf[0] = (val >> 24) & 0xFFU;
+		buf[1] = (val >> 16) & 0xFFU;
+		buf[2] = (val >> 8) & 0xFFU;
+		buf[3] = (val >> 0) & 0xFFU;
+		break;
+	}
+}
+
+static uint32_t ttc_decode_switch(uint8_t adr, const uint8_t *buf)
+{
+	uint32_t val = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+		       ((uint32_t)buf[2] << 8) | ((uint32_t)buf[3] << 0);
+
+	switch (adr) {
+	case SL_TTC2_REG_DEVICE_ID:
+	case SL_TTC2_REG_RESET_COUNTER:
+	case SL_TTC2_REG_INPUT_VOLTAGE_MCU:
+	case SL_TTC2_REG_INPUT_CURRENT_MCU:
+	case SL_TTC2_REG_TEMPERATURE_MCU:
+	case SL_TTC2_REG_INPUT_VOLTAGE_RADIO:
+	case SL_TTC2_REG_INPUT_CURRENT_RADIO:
+	case SL_TTC2_REG_TEMPERATURE_RADIO:
+	case SL_TTC2_REG_RSSI_LAST_VALID_TC:
+	case SL_TTC2_REG_TEMPERATURE_ANTENNA:
+	case SL_TTC2_REG_ANTENNA_STATUS:
+	case SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO:
+		return val >> 16;
+	case SL_TTC2_REG_HARDWARE_VERSION:
+	case SL_TTC2_REG_LAST_RESET_CAUSE:
+	case SL_TTC2_REG_LAST_VALID_TC:
+	case SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS:
+	case SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS:
+	case SL_TTC2_REG_TX_ENABLE:
+	case SL_TTC2_REG_FIFO_TX_PACKET:
+	case SL_TTC2_REG_FIFO_RX_PACKET:
+		return val >> 24;
+	default:
+		return val;
+	}
+}
+
+static uint8_t eps_class_switch(uint8_t adr)
+{
+	if (adr < SL_EPS2_REG_BAT_MONITOR_TEMP_K)
+		return SL_EPS2_REG_CLASS_MEASUREMENT;
+
+	if (adr <= SL_EPS2_REG_BAT_MONITOR_RSRC_PERC)
+		return SL_EPS2_REG_CLASS_BAT_MONITOR;
+
+	return SL_EPS2_REG_CLASS_CONFIG;
+}
+
+static uint8_t adrs[4096];
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double start)
+{
+	printf("%-24s %6.2f ns/op\n", name, (now_ns() - start) / ITERATIONS);
+}
+
+int main(void)
+{
+	uint8_t buf[4] = { 0 };
+	uint32_t acc = 0U;
+	uint32_t x = 1U;
+	double start;
+
+	for (unsigned int i = 0U; i < sizeof(adrs); ++i) {
+		x = (x * 1103515245U) + 12345U;
+		adrs[i] = (uint8_t)((x >> 16) % SL_TTC2_REG_COUNT);
+	}
+
+	start = now_ns();
+	for (unsigned long i = 0UL; i < ITERATIONS; ++i) {
+		uint8_t adr = adrs[i % sizeof(adrs)];
+
+		ttc_encode_switch(adr, (uint32_t)i, buf);
+		acc += ttc_decode_switch(adr, buf);
+	}
+	report("ttc codec, switch", start);
+
+	start = now_ns();
+	for (unsigned long i = 0UL; i < ITERATIONS; ++i) {
+		uint8_t adr = adrs[i % sizeof(adrs)];
+
+		sl_ttc2_encode_reg(adr, (uint32_t)i, buf);
+		acc += sl_ttc2_decode_reg(adr, buf);
+	}
+	report("ttc codec, table", start);
+
+	for (unsigned int i = 0U; i < sizeof(adrs); ++i)
+		adrs[i] = (uint8_t)(adrs[i] * 2U);
+
+	start = now_ns();
+	for (unsigned long i = 0UL; i < ITERATIONS; ++i)
+		acc += eps_class_switch(adrs[i % sizeof(adrs)]);
+	report("eps reg class, ranges", start);
+
+	start = now_ns();
+	for (unsigned long i = 0UL; i < ITERATIONS; ++i)
+		acc += sl_eps2_get_reg_class(adrs[i % sizeof(adrs)]);
+	report("eps reg class, table", start);
+
+	sink = acc;
+
+	return EXIT_SUCCESS;
+}
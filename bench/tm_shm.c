@@ -0,0 +1,152 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <system/tm_shm.h>
+#include <system/tm_shm_reader.h>
+
+/*
+ * Throughput of the telemetry shared memory segment: one writer publishing
+ * a full size record as fast as it can, against 0 to READERS_MAX readers
+ * copying it in a loop. Each sample is filled with a single byte value, so
+ * a reader seeing two different bytes in a snapshot found a torn read.
+ */
+
+#define READERS_MAX 4U
+
+#define RUN_NS 1000000000.0
+
+static atomic_bool stop;
+
+static char shm_name[32];
+
+struct reader_stats {
+	unsigned long reads;
+	unsigned long failed;
+	unsigned long torn;
+};
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static void *writer(void *arg)
+{
+	uint8_t buf[TM_PUB_PAYLOAD_MAX];
+	unsigned long *writes = arg;
+
+	while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+		memset(buf, (int)(*writes & 0xFFU), sizeof(buf));
+		tm_shm_publish(TM_PUB_EPS_DATA, 0U, buf, sizeof(buf));
+		(*writes)++;
+	}
+
+	return NULL;
+}
+
+static void *reader(void *arg)
+{
+	struct reader_stats *stats = arg;
+	struct tm_shm_reader shm;
+	uint8_t buf[TM_PUB_PAYLOAD_MAX];
+
+	if (tm_shm_reader_open(&shm, shm_name) != 0) {
+		stats->failed = 1UL;
+		return NULL;
+	}
+
+	while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+		long len = tm_shm_read(&shm, TM_PUB_EPS_DATA, 0U, buf,
+				       sizeof(buf), NULL);
+
+		stats->reads++;
+
+		if (len < 0) {
+			stats->failed++;
+			continue;
+		}
+
+		for (long i = 1; i < len; ++i) {
+			if (buf[i] != buf[0]) {
+				stats->torn++;
+				break;
+			}
+		}
+	}
+
+	tm_shm_reader_close(&shm);
+
+	return NULL;
+}
+
+static void run(unsigned int readers)
+{
+	pthread_t tids[READERS_MAX + 1U];
+	struct reader_stats stats[READERS_MAX];
+	unsigned long writes = 0UL;
+	unsigned long reads = 0UL;
+	unsigned long failed = 0UL;
+	unsigned long torn = 0UL;
+
+	memset(stats, 0, sizeof(stats));
+	atomic_store(&stop, false);
+
+	double start = now_ns();
+
+	pthread_create(&tids[0], NULL, writer, &writes);
+
+	for (unsigned int i = 0U; i < readers; ++i)
+		pthread_create(&tids[i + 1U], NULL, reader, &stats[i]);
+
+	while ((now_ns() - start) < RUN_NS)
+		usleep(10000U);
+
+	atomic_store(&stop, true);
+
+	for (unsigned int i = 0U; i <= readers; ++i)
+		pthread_join(tids[i], NULL);
+
+	double ns = now_ns() - start;
+
+	for (unsigned int i = 0U; i < readers; ++i) {
+		reads += stats[i].reads;
+		failed += stats[i].failed;
+		torn += stats[i].torn;
+	}
+
+	printf("%u readers: %7.2f M writes/s, %7.2f M reads/s per reader, "
+	       "%lu failed, %lu torn\n",
+	       readers, ((double)writes * 1e3) / ns,
+	       (readers > 0U) ? (((double)reads * 1e3) / ns / readers) : 0.0,
+	       failed, torn);
+}
+
+int main(void)
+{
+	snprintf(shm_name, sizeof(shm_name), "/obdh2-bench-tm-%d",
+		 (int)getpid());
+
+	if (tm_shm_init(shm_name) != 0) {
+		perror("Could not create the shared memory segment");
+		return EXIT_FAILURE;
+	}
+
+	for (unsigned int readers = 0U; readers <= READERS_MAX; ++readers)
+		run(readers);
+
+	shm_unlink(shm_name);
+
+	return EXIT_SUCCESS;
+}
@@ -43,6 +43,11 @@
 
 #define EPS_MODULE_NAME         "eps"
 
+/* Time a written or read register value is served from the shadow */
+#define EPS_SHADOW_TTL_STATIC_MS        UINT32_MAX  /**< IDs and versions, kept until the EPS resets. */
+#define EPS_SHADOW_TTL_CONFIG_MS        60000U      /**< Modes, duty cycles and enables. */
+#define EPS_SHADOW_TTL_MEASUREMENT_MS   0U          /**< Measurements and commands, never kept. */
+
 /**
  * \brief Parameter ID type.
  */
@@ -58,6 +63,9 @@ int eps_init(void);
 /**
  * \brief Sets a parameter of the EPS device.
  *
+ * The write is skipped when the shadow of the register, see
+ * EPS_SHADOW_TTL_CONFIG_MS, already holds the value.
+ *
  * \param[in] param is the parameter ID to set.
  *
  * \param[in] val is the new value of the given parameter.
@@ -69,6 +77,9 @@ int eps_set_param(eps_param_id_t param, uint32_t val);
 /**
  * \brief Gets a parameter from the EPS device.
  *
+ * Served from the shadow of the register while its value is younger than the
+ * TTL of the register.
+ *
  * \param[in] param is the parameter ID to read.
  *
  * \param[in,out] val is a pointer to store the read value.
@@ -113,6 +124,23 @@ int eps_get_bat_charge(eps_charge_t *charge);
  */
 int eps_get_data(eps_data_t *data);
 
+/**
+ * \brief Locks the EPS device for a sequence of operations.
+ *
+ * Every EPS operation takes this (recursive) lock, so holding it keeps other
+ * threads off the device between operations.
+ *
+ * \return None.
+ */
+void eps_lock(void);
+
+/**
+ * \brief Unlocks the EPS device.
+ *
+ * \return None.
+ */
+void eps_unlock(void);
+
 /**
  * \brief Prints EPS data.
  *
@@ -24,4 +24,17 @@
 int payload_edc_init(uint8_t edc_id, struct payload *edc, edc_config_t *edc_conf,
                      struct payload_ctx *edc_ctx);
 
+/**
+ * @brief Locks the EDC payloads for a sequence of operations.
+ *
+ * Every EDC payload operation takes this (recursive) lock, so holding it
+ * keeps other threads off the device between operations.
+ */
+void payload_edc_lock(void);
+
+/**
+ * @brief Unlocks the EDC payloads.
+ */
+void payload_edc_unlock(void);
+
 #endif
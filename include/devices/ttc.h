@@ -47,6 +47,8 @@
 
 #define TTC_MAX_FAILED_PACKETS     2U
 
+#define TTC_COUNT                  2U
+
 /**
  * \brief TTC configuration parameters.
  */
@@ -132,6 +134,20 @@ int ttc_get_param(ttc_e dev, ttc_param_id_t param, uint32_t *val);
  */
 int ttc_get_data(ttc_e dev, ttc_data_t *data);
 
+/**
+ * \brief Reads the housekeeping data from both TTC devices at once.
+ *
+ * The register reads of the two devices are interleaved, so each one waits
+ * for its replies while the other is being read.
+ *
+ * \param[in,out] data is an array of TTC_COUNT elements, indexed by ttc_e, to store the read TTC data.
+ *
+ * \param[in,out] err is an array of TTC_COUNT elements, indexed by ttc_e, to store the status/error code of each device.
+ *
+ * \return The status/error code, -1 if any device failed.
+ */
+int ttc_get_data_all(ttc_data_t *data, int *err);
+
 /**
  * \brief Sends a downlink packet to the TTC device.
  *
@@ -241,6 +257,20 @@ int ttc_check_failed_pkts(ttc_e dev);
  */
 void ttc_print_data(const ttc_e dev, const ttc_data_t *data);
 
+/**
+ * \brief Locks the TTC devices for a sequence of operations.
+ *
+ * \return None.
+ */
+void ttc_lock(void);
+
+/**
+ * \brief Unlocks the TTC devices.
+ *
+ * \return None.
+ */
+void ttc_unlock(void);
+
 #endif /* TTC_H_ */
 
 /** \} End of ttc group */
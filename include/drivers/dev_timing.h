@@ -0,0 +1,160 @@
+/*
+ * dev_timing.h
+ *
+ * Copyright The OBDH 2.0 Contributors
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief Adaptive device response timing.
+ *
+ * Instead of sleeping a fixed time between a request and the read of its
+ * response, the drivers poll for a valid response. The first poll is done
+ * a bit before the response latency learnt from the previous requests, and
+ * the next ones with an exponential backoff, up to a limit. The learnt
+ * latencies can be saved to a file and loaded at the next start.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \defgroup dev_timing Device Timing
+ * \ingroup drivers
+ * \{
+ */
+
+#ifndef DEV_TIMING_H_
+#define DEV_TIMING_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DEV_TIMING_NOT_READY            1       /**< Returned by a poll function when there is no valid response yet. */
+#define DEV_TIMING_STALE                2       /**< Returned by a poll function for a valid response that may be left from a previous request. */
+
+#define DEV_TIMING_MAX                  8U      /**< Number of timings in a calibration file. */
+#define DEV_TIMING_NAME_MAX             24U     /**< Length of a timing name, with the terminator. */
+
+#define DEV_TIMING_BACKOFF_MIN_US       500U    /**< First retry interval, unless the timing has a longer one. */
+#define DEV_TIMING_BACKOFF_MAX_US       8000U   /**< Longest retry interval. */
+
+/**
+ * \brief Response timing of a device.
+ */
+struct dev_timing {
+    const char *name;               /**< Key in the calibration file. */
+    uint32_t floor_us;              /**< Earliest poll after the request, e.g. a protocol minimum gap. */
+    uint32_t limit_us;              /**< Latest poll after the request. */
+    uint32_t backoff_min_us;        /**< Shortest interval between two polls, e.g. a protocol minimum gap, 0 for DEV_TIMING_BACKOFF_MIN_US. */
+    atomic_uint latency_us;         /**< Learnt response latency, 0 before the first response. */
+    atomic_bool registered;
+    struct dev_timing *next;
+};
+
+#define DEV_TIMING_INIT(n, floor, limit)                                        \
+    { .name = (n), .floor_us = (floor), .limit_us = (limit) }
+
+#define DEV_TIMING_INIT_GAP(n, floor, limit, gap)                               \
+    { .name = (n), .floor_us = (floor), .limit_us = (limit), .backoff_min_us = (gap) }
+
+/**
+ * \brief Checks for the response of a request.
+ *
+ * \param[in] arg is the argument given to dev_timing_wait().
+ *
+ * A stale response is polled for again like DEV_TIMING_NOT_READY, but is
+ * accepted if it is still there when the limit is reached, as a new response
+ * may be identical to the previous one.
+ *
+ * \return 0 on a valid response, DEV_TIMING_NOT_READY, DEV_TIMING_STALE, or -1 on errors that a retry won't fix.
+ */
+typedef int (*dev_timing_poll_t)(void *arg);
+
+/**
+ * \brief Waits for the response of a request that was just sent.
+ *
+ * \param[in,out] timing is the timing of the device, updated with the latency of the response.
+ *
+ * \param[in] poll is the function checking for the response.
+ *
+ * \param[in] arg is passed to poll.
+ *
+ * \return 0 once poll accepted a response, -1 on error or when the limit was reached.
+ */
+int dev_timing_wait(struct dev_timing *timing, dev_timing_poll_t poll, void *arg);
+
+/**
+ * \brief Waits for the response of a request sent at a given time.
+ *
+ * Lets a caller do other work, e.g. send a request to another device, between
+ * sending a request and waiting for its response.
+ *
+ * \param[in,out] timing is the timing of the device, updated with the latency of the response.
+ *
+ * \param[in] start is the time the request was sent, from dev_timing_now_us().
+ *
+ * \param[in] poll is the function checking for the response.
+ *
+ * \param[in] arg is passed to poll.
+ *
+ * \return 0 once poll accepted a response, -1 on error or when the limit was reached.
+ */
+int dev_timing_wait_from(struct dev_timing *timing, uint64_t start, dev_timing_poll_t poll, void *arg);
+
+/**
+ * \brief Gets the current monotonic time.
+ *
+ * \return The time in microseconds.
+ */
+uint64_t dev_timing_now_us(void);
+
+/**
+ * \brief Updates the learnt latency of a device.
+ *
+ * \param[in,out] timing is the timing of the device.
+ *
+ * \param[in] us is the latency of a response.
+ */
+void dev_timing_record(struct dev_timing *timing, uint32_t us);
+
+/**
+ * \brief Loads learnt latencies saved by dev_timing_save().
+ *
+ * Timings not used yet get their latency when first used.
+ *
+ * \param[in] path is the calibration file.
+ *
+ * \return The status/error code.
+ */
+int dev_timing_load(const char *path);
+
+/**
+ * \brief Saves the learnt latencies of the timings used so far.
+ *
+ * \param[in] path is the calibration file, replaced atomically.
+ *
+ * \return The status/error code.
+ */
+int dev_timing_save(const char *path);
+
+#endif /* DEV_TIMING_H_ */
+
+/** \} End of dev_timing group */
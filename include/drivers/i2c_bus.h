@@ -0,0 +1,99 @@
+/*
+ * i2c_bus.h
+ *
+ * Copyright The OBDH 2.0 Contributors
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief Shared I2C adapter handles.
+ *
+ * Each adapter is opened once and kept open. The slave address is only
+ * set again when it changes, and the adapter is reopened when a transfer
+ * fails with ENODEV or EIO.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \defgroup i2c_bus I2C Bus
+ * \ingroup drivers
+ * \{
+ */
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+#include <stdint.h>
+#include <linux/i2c.h>
+
+#define I2C_BUS_MAX             4U      /**< Number of adapters that can be open at once. */
+#define I2C_BUS_PATH_MAX        24U     /**< Length of an adapter path, e.g. "/dev/i2c-2". */
+#define I2C_BUS_MSGS_MAX        42U     /**< Messages in a transaction, I2C_RDWR_IOCTL_MAX_MSGS. */
+
+/**
+ * \brief Writes a sequence of bytes to an I2C slave.
+ *
+ * \param[in] dev is the adapter character device, e.g. "/dev/i2c-2".
+ *
+ * \param[in] adr is the 7-bit slave address.
+ *
+ * \param[in] data is the array of bytes to write.
+ *
+ * \param[in] len is the number of bytes to write.
+ *
+ * \return The status/error code.
+ */
+int i2c_bus_write(const char *dev, uint8_t adr, const uint8_t *data, uint16_t len);
+
+/**
+ * \brief Reads a sequence of bytes from an I2C slave.
+ *
+ * \param[in] dev is the adapter character device, e.g. "/dev/i2c-2".
+ *
+ * \param[in] adr is the 7-bit slave address.
+ *
+ * \param[in,out] data is a pointer to store the read bytes.
+ *
+ * \param[in] len is the number of bytes to read.
+ *
+ * \return The status/error code.
+ */
+int i2c_bus_read(const char *dev, uint8_t adr, uint8_t *data, uint16_t len);
+
+/**
+ * \brief Runs several I2C messages in a single transaction.
+ *
+ * The messages are issued by one I2C_RDWR ioctl, with a repeated start and
+ * no stop condition between them.
+ *
+ * \param[in] dev is the adapter character device, e.g. "/dev/i2c-2".
+ *
+ * \param[in,out] msgs are the messages, each one with its slave address.
+ *
+ * \param[in] nmsgs is the number of messages, up to I2C_BUS_MSGS_MAX.
+ *
+ * \return The status/error code.
+ */
+int i2c_bus_transfer(const char *dev, struct i2c_msg *msgs, unsigned int nmsgs);
+
+#endif /* I2C_BUS_H_ */
+
+/** \} End of i2c_bus group */
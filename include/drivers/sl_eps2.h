@@ -98,9 +98,30 @@
 #define SL_EPS2_REG_RESET_EPS                   49      /**< Used to reset EPS device */
 #define SL_EPS2_REG_PAYLOAD_ENABLE              50      /**< Enable/Disable payload power source (0x00 = disable, 0x01 = enable) */
 #define SL_EPS2_REG_BEACON_ENABLE               51      /**< Enable/Disable EPS beacon (0x00 = disable, 0x01 = enable) */
+#define SL_EPS2_REG_COUNT                       52U     /**< Number of registers. */
 
 #define SL_EPS2_OP_OK                           0U
 
+/* Register classes, see sl_eps2_set_settle_time() */
+#define SL_EPS2_REG_CLASS_CONFIG                0U      /**< Modes, duty cycles, versions and commands. */
+#define SL_EPS2_REG_CLASS_MEASUREMENT           1U      /**< ADC measurements and counters. */
+#define SL_EPS2_REG_CLASS_BAT_MONITOR           2U      /**< Registers fetched from the battery monitor IC. */
+#define SL_EPS2_REG_CLASS_COUNT                 3U
+
+#define SL_EPS2_SETTLE_TIME_CONFIG_MS           0U      /**< Default settle time of configuration registers. */
+#define SL_EPS2_SETTLE_TIME_MEASUREMENT_MS      10U     /**< Default settle time of measurement registers. */
+#define SL_EPS2_SETTLE_TIME_BAT_MONITOR_MS      50U     /**< Default settle time of battery monitor registers. */
+
+#define SL_EPS2_RESPONSE_FLOOR_US               1000U   /**< Earliest poll for the reply of a register with a settle time. */
+
+#define SL_EPS2_I2C_MSGS_MAX                    42U     /**< Messages in a single I2C transaction. */
+#define SL_EPS2_READ_REGS_MAX                   64U     /**< Registers in a single sl_eps2_read_regs() call. */
+
+/* Status of each register read by sl_eps2_read_regs() */
+#define SL_EPS2_REG_OK                          0       /**< The register was read. */
+#define SL_EPS2_REG_ERR_BUS                     (-1)    /**< The I2C transfer failed. */
+#define SL_EPS2_REG_ERR_CRC                     (-2)    /**< The reply has an invalid CRC. */
+
 /**
  * \brief Solar panels.
  */
@@ -261,6 +282,16 @@ typedef struct {
     int todo;
 } sl_eps2_config_t ;
 
+/**
+ * \brief I2C message of a transaction, see sl_eps2_i2c_transfer().
+ */
+typedef struct
+{
+    uint8_t                 *data;                      /**< Bytes to write or buffer to read into. */
+    uint16_t                len;                        /**< Number of bytes. */
+    uint8_t                 rd;                         /**< 1 to read, 0 to write. */
+} sl_eps2_i2c_msg_t;
+
 /**
  * \brief Initialization of the EPS module driver.
  *
@@ -307,14 +338,97 @@ int sl_eps2_write_reg(sl_eps2_config_t config, uint8_t adr, uint32_t val);
  */
 int sl_eps2_read_reg(sl_eps2_config_t config, uint8_t adr, uint32_t *val);
 
+/**
+ * \brief Reads several registers from the EPS module.
+ *
+ * The requests and replies of consecutive registers are pipelined in as few
+ * I2C transactions as their settle times allow: a transaction only ends
+ * when the last request written needs time to settle, and its reply is
+ * then polled for, starting at the latency learnt for its class, until a
+ * valid frame is read. Every reply has its CRC checked.
+ *
+ * \param[in] config is a structure with the configuration parameters of the driver.
+ *
+ * \param[in] adr is the array of register addresses to read.
+ *
+ * \param[in] count is the number of registers, up to SL_EPS2_READ_REGS_MAX.
+ *
+ * \param[in,out] val is an array to store the read values, untouched on error.
+ *
+ * \param[in,out] status is an array to store the status of each register (SL_EPS2_REG_OK or SL_EPS2_REG_ERR_*).
+ *
+ * \return The number of registers that could not be read, or -1 on invalid arguments.
+ */
+int sl_eps2_read_regs(sl_eps2_config_t config, const uint8_t *adr, uint8_t count, uint32_t *val,
+                      int8_t *status);
+
+/**
+ * \brief Gets the class of a register.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \return The register class (SL_EPS2_REG_CLASS_*).
+ */
+uint8_t sl_eps2_get_reg_class(uint8_t adr);
+
+/**
+ * \brief Gets the width of the value of a register.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \return The number of bytes kept by the typed reads (1, 2 or 4).
+ */
+uint8_t sl_eps2_get_reg_width(uint8_t adr);
+
+/**
+ * \brief Encodes the value of a register in the data bytes of a packet.
+ *
+ * Every register has 4 data bytes, whatever its width.
+ *
+ * \param[in] val is the value to encode.
+ *
+ * \param[in,out] buf is an array of 4 bytes to store the value, MSB first.
+ *
+ * \return None.
+ */
+void sl_eps2_encode_reg(uint32_t val, uint8_t *buf);
+
+/**
+ * \brief Decodes the value of a register from the data bytes of a packet.
+ *
+ * \param[in] buf is an array with the 4 data bytes of the packet, MSB first.
+ *
+ * \return The value of the register.
+ */
+uint32_t sl_eps2_decode_reg(const uint8_t *buf);
+
+/**
+ * \brief Sets the time the EPS firmware needs to prepare a register read.
+ *
+ * Registers of a class with no settle time are written and read back in
+ * the same I2C transaction. The others end the transaction after their
+ * request, and their reply is polled for until it is valid, for up to twice
+ * the settle time.
+ *
+ * \param[in] reg_class is the register class (SL_EPS2_REG_CLASS_*).
+ *
+ * \param[in] ms is the settle time in milliseconds.
+ *
+ * \return The status/error code.
+ */
+int sl_eps2_set_settle_time(uint8_t reg_class, uint32_t ms);
+
 /**
  * \brief Reads all the EPS variables and parameters.
  *
+ * All the registers are read by a single sl_eps2_read_regs() call. Fields of registers
+ * that could not be read are left untouched.
+ *
  * \param[in] config is a structure with the configuration parameters of the driver.
  *
  * \param[in,out] data is a pointe to store the read EPS data.
  *
- * \return The status/error code.
+ * \return The number of registers that could not be read.
  */
 int sl_eps2_read_data(sl_eps2_config_t config, sl_eps2_data_t *data);
 
@@ -760,6 +874,19 @@ int sl_eps2_i2c_write(sl_eps2_config_t config, uint8_t *data, uint16_t len);
  */
 int sl_eps2_i2c_read(sl_eps2_config_t config, uint8_t *data, uint16_t len);
 
+/**
+ * \brief Runs a sequence of I2C messages in a single transaction.
+ *
+ * The messages are separated by repeated starts, with no stop condition between them.
+ *
+ * \param[in,out] msgs are the messages to write or read.
+ *
+ * \param[in] nmsgs is the number of messages, up to SL_EPS2_I2C_MSGS_MAX.
+ *
+ * \return The status/error code.
+ */
+int sl_eps2_i2c_transfer(sl_eps2_config_t config, sl_eps2_i2c_msg_t *msgs, uint8_t nmsgs);
+
 /**
  * \brief Milliseconds delay.
  *
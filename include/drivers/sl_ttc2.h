@@ -46,13 +46,16 @@
 /* TTC 2.0 IDs */
 #define SL_TTC2_DEVICE_ID_RADIO_0               0xCC2AU /**< TTC 2.0 device ID (radio 1). */
 #define SL_TTC2_DEVICE_ID_RADIO_1               0xCC2BU /**< TTC 2.0 device ID (radio 2). */
+#define SL_TTC2_RADIOS_MAX                      2U      /**< Number of radios, see sl_ttc2_radio_e. */
 
 /* TTC 2.0 Mutex wait time */
 #define SL_TTC2_MUTEX_WAIT_TIME_MS              5000U   /**< TTC 2.0 mutex wait time. */
 
 /* TTC 2.0 Protocol timing */
 #define SL_TTC2_TRANSACTION_DELAY_MS            110U   /**< TTC 2.0 protocol transaction delay. */
-#define SL_TTC2_EXTRA_MUTEX_DELAY_MS            100U     /**< Delay after transaction, used to give TTC 2.0 more time to process next request. */
+#define SL_TTC2_EXTRA_MUTEX_DELAY_MS            100U     /**< Gap after a transaction, used to give TTC 2.0 more time to process next request. */
+#define SL_TTC2_RESPONSE_FLOOR_US               1000U   /**< Earliest poll for the reply of a register read. */
+#define SL_TTC2_RESPONSE_LIMIT_MS               220U    /**< Latest poll for the reply of a register read. */
 
 /* TTC 2.0 Preamble byte */
 #define SL_TTC2_PKT_PREAMBLE                    0x7EU   /**< Preamble byte value. */
@@ -91,6 +94,7 @@
 #define SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO 23U     /**< Number of bytes of the first available packet in the RX buffer. */
 #define SL_TTC2_REG_RESET_DEVICE                24U     /**< Register to reset device */
 #define SL_TTC2_REG_CONSEQ_FAILED_PACKETS       25U     /**< Number of consecutive radio decoding errors */
+#define SL_TTC2_REG_COUNT                       26U     /**< Number of registers, see sl_ttc2_get_reg_width(). */
 
 /**
  * \brief Temperature type.
@@ -191,6 +195,18 @@ typedef struct
     sl_ttc2_radio_e id;             /**< Device ID (radio 1 or 2). */
 } sl_ttc2_config_t;
 
+/**
+ * \brief Register reads of a radio, see sl_ttc2_read_regs_multi().
+ */
+typedef struct
+{
+    sl_ttc2_config_t        *config;                    /**< Radio to read from. */
+    const uint8_t           *adr;                       /**< Register addresses. */
+    uint8_t                 count;                      /**< Number of registers. */
+    uint32_t                *val;                       /**< Read values, untouched for registers that failed. */
+    int                     failed;                     /**< Number of registers that could not be read. */
+} sl_ttc2_read_t;
+
 /**
  * \brief Initialization of the TTC module driver.
  *
@@ -237,6 +253,104 @@ int sl_ttc2_write_reg(sl_ttc2_config_t *config, uint8_t adr, uint32_t val);
  */
 int sl_ttc2_read_reg(sl_ttc2_config_t *config, uint8_t adr, uint32_t *val);
 
+/**
+ * \brief Sends the request of a register read.
+ *
+ * First half of a split-phase read: the SPI bus is only held while the
+ * request is clocked, and the reply is read by sl_ttc2_read_reg_end(). The
+ * caller holds the radio mutex from here to the end of the read. Waits for
+ * the gap after the previous transaction of the radio, if needed.
+ *
+ * \param[in] config is a structure with the configuration parameters of the driver.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \return The status/error code.
+ */
+int sl_ttc2_read_reg_begin(sl_ttc2_config_t *config, uint8_t adr);
+
+/**
+ * \brief Reads the reply of a register read started by sl_ttc2_read_reg_begin().
+ *
+ * Polls for the reply, from the latency learnt for the radio after the
+ * request was sent. The SPI bus is released between polls.
+ *
+ * \param[in] config is a structure with the configuration parameters of the driver.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \param[in,out] val is a pointer to store the read value, untouched on error.
+ *
+ * \return The status/error code.
+ */
+int sl_ttc2_read_reg_end(sl_ttc2_config_t *config, uint8_t adr, uint32_t *val);
+
+/**
+ * \brief Reads several registers from the TTC module.
+ *
+ * \param[in] config is a structure with the configuration parameters of the driver.
+ *
+ * \param[in] adr is the array of register addresses to read.
+ *
+ * \param[in] count is the number of registers.
+ *
+ * \param[in,out] val is an array to store the read values, untouched on error.
+ *
+ * \return The number of registers that could not be read, or -1 on invalid arguments.
+ */
+int sl_ttc2_read_regs(sl_ttc2_config_t *config, const uint8_t *adr, uint8_t count, uint32_t *val);
+
+/**
+ * \brief Reads registers from several radios at once.
+ *
+ * The split-phase reads of the radios are interleaved: the request to each
+ * radio is sent before waiting for any reply, so the turnaround and the gap
+ * after the transaction of a radio overlap the ones of the others.
+ *
+ * \param[in,out] reads are the reads, one per radio, with their failed count set on return.
+ *
+ * \param[in] n is the number of reads, up to SL_TTC2_RADIOS_MAX.
+ *
+ * \return The status/error code, -1 on invalid arguments.
+ */
+int sl_ttc2_read_regs_multi(sl_ttc2_read_t *reads, uint8_t n);
+
+/**
+ * \brief Gets the width of the value of a register.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \return The number of bytes of the value (1, 2 or 4).
+ */
+uint8_t sl_ttc2_get_reg_width(uint8_t adr);
+
+/**
+ * \brief Encodes the value of a register in the data bytes of a packet.
+ *
+ * The value is written MSB first, using as many bytes as the register width,
+ * and the remaining bytes are zeroed.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \param[in] val is the value to encode.
+ *
+ * \param[in,out] buf is an array of 4 bytes to store the encoded value.
+ *
+ * \return None.
+ */
+void sl_ttc2_encode_reg(uint8_t adr, uint32_t val, uint8_t *buf);
+
+/**
+ * \brief Decodes the value of a register from the data bytes of a packet.
+ *
+ * \param[in] adr is the register address.
+ *
+ * \param[in] buf is an array with the 4 data bytes of the packet.
+ *
+ * \return The value of the register.
+ */
+uint32_t sl_ttc2_decode_reg(uint8_t adr, const uint8_t *buf);
+
 /**
  * \brief Reads all the TTC variables and parameters.
  *
@@ -248,6 +362,23 @@ int sl_ttc2_read_reg(sl_ttc2_config_t *config, uint8_t adr, uint32_t *val);
  */
 int sl_ttc2_read_hk_data(sl_ttc2_config_t *config, sl_ttc2_hk_data_t *data);
 
+/**
+ * \brief Reads the TTC variables and parameters of several radios at once.
+ *
+ * \see sl_ttc2_read_regs_multi()
+ *
+ * \param[in] config are the configurations of the radios.
+ *
+ * \param[in,out] data is an array to store the read TTC data, one per radio.
+ *
+ * \param[in,out] failed is an array to store the number of registers that could not be read, one per radio.
+ *
+ * \param[in] n is the number of radios, up to SL_TTC2_RADIOS_MAX.
+ *
+ * \return The status/error code, -1 on invalid arguments.
+ */
+int sl_ttc2_read_hk_data_multi(sl_ttc2_config_t **config, sl_ttc2_hk_data_t *data, int *failed, uint8_t n);
+
 /**
  * \brief Reads the device ID of the TTC module.
  *
@@ -537,6 +668,10 @@ int sl_ttc2_read_packet(sl_ttc2_config_t *config, uint8_t *data, uint16_t *len);
 /**
  * \brief SPI interface initialization.
  *
+ * Opens the SPI device of the radio and sets its mode, word size and clock
+ * once. The device is kept open, and reopened on the next transfer after a
+ * failure.
+ *
  * \param[in] config is a structure with the configuration parameters of the driver.
  *
  * \return The status/error code.
@@ -594,19 +729,43 @@ int sl_ttc2_spi_transfer(sl_ttc2_config_t *config, uint8_t *wdata, uint8_t *rdat
 void sl_ttc2_delay_ms(uint32_t ms);
 
 /**
- * \brief Takes the sl_ttc2 mutex.
+ * \brief Takes the sl_ttc2 SPI bus mutex.
+ *
+ * Only held while bytes are clocked, never across a device turnaround.
  *
  * \return The status/error code.
  */
 int sl_ttc2_mutex_take(void);
 
 /**
- * \brief Gives the sl_ttc2 mutex.
+ * \brief Gives the sl_ttc2 SPI bus mutex.
  *
  * \return The status/error code.
  */
 int sl_ttc2_mutex_give(void);
 
+/**
+ * \brief Takes the mutex of a radio.
+ *
+ * Held for a whole transaction with the radio, including the waits. The
+ * mutex is recursive: it can be held across several driver calls. When both
+ * radios are needed, radio 0 is taken first.
+ *
+ * \param[in] radio is the radio ID (sl_ttc2_radio_e).
+ *
+ * \return The status/error code.
+ */
+int sl_ttc2_radio_mutex_take(uint8_t radio);
+
+/**
+ * \brief Gives the mutex of a radio.
+ *
+ * \param[in] radio is the radio ID (sl_ttc2_radio_e).
+ *
+ * \return The status/error code.
+ */
+int sl_ttc2_radio_mutex_give(uint8_t radio);
+
 #endif /* SL_TTC2_H_ */
 
 /** \} End of sl_ttc2 group */
@@ -0,0 +1,123 @@
+#ifndef BLACKBOARD_H_
+#define BLACKBOARD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <devices/eps_data.h>
+#include <system/dev_health.h>
+#include <system/evloop.h>
+#include <system/tm_pub.h>
+
+/*
+ * State shared between the tasks, each entry written by a single task and
+ * read by any. The eclipse flag and the device health are atomics, the
+ * orbit and the battery state are structures guarded by a seqlock, so no
+ * reader ever blocks a writer. A task subscribed to an entry is triggered
+ * (see evloop_trigger()) whenever the entry changes, to react right away
+ * instead of at its next period.
+ */
+
+/* Tasks that can subscribe to an entry */
+#define BLACKBOARD_SUBSCRIBERS_MAX 4U
+
+enum blackboard_key {
+	BLACKBOARD_ECLIPSE = 0,
+	BLACKBOARD_ORBIT,
+	BLACKBOARD_BATTERY,
+	BLACKBOARD_HEALTH,
+	BLACKBOARD_KEY_COUNT,
+};
+
+/* Devices whose health is on the blackboard, see dev_health_publish_t */
+enum blackboard_dev {
+	BLACKBOARD_DEV_EPS = 0,
+	BLACKBOARD_DEV_TTC_0,
+	BLACKBOARD_DEV_TTC_1,
+	BLACKBOARD_DEV_COUNT,
+};
+
+struct blackboard_battery {
+	eps_voltage_t voltage;
+	eps_current_t current;
+	eps_charge_t charge;
+	uint16_t temperature; /**< Of the battery monitor. */
+};
+
+/**
+ * \brief Subscribes a task to the changes of an entry.
+ *
+ * \param[in] key is the entry.
+ *
+ * \param[in] task is the task to trigger, which must outlive the program.
+ *
+ * \return 0 on success, -1 if the entry has too many subscribers.
+ */
+int blackboard_subscribe(enum blackboard_key key, struct evloop_task *task);
+
+/**
+ * \brief Sets whether the satellite is in eclipse.
+ *
+ * \param[in] eclipsed is true in eclipse.
+ */
+void blackboard_set_eclipsed(bool eclipsed);
+
+/**
+ * \brief Gets whether the satellite is in eclipse.
+ *
+ * \return true in eclipse, false otherwise or before the first orbit.
+ */
+bool blackboard_get_eclipsed(void);
+
+/**
+ * \brief Sets the orbit solution.
+ *
+ * \param[in] orbit is the orbit solution.
+ */
+void blackboard_set_orbit(const tm_pub_orbit_t *orbit);
+
+/**
+ * \brief Gets the last orbit solution.
+ *
+ * \param[out] orbit is the orbit solution.
+ *
+ * \return false if there is no solution yet.
+ */
+bool blackboard_get_orbit(tm_pub_orbit_t *orbit);
+
+/**
+ * \brief Sets the battery state.
+ *
+ * \param[in] battery is the battery state.
+ */
+void blackboard_set_battery(const struct blackboard_battery *battery);
+
+/**
+ * \brief Gets the last battery state.
+ *
+ * \param[out] battery is the battery state.
+ *
+ * \return false if there is no state yet.
+ */
+bool blackboard_get_battery(struct blackboard_battery *battery);
+
+/**
+ * \brief Sets the health of a device.
+ *
+ * \param[in] dev is the device.
+ *
+ * \param[in] state is its health.
+ */
+void blackboard_set_health(enum blackboard_dev dev,
+			   enum dev_health_state state);
+
+/**
+ * \brief Gets the health of a device.
+ *
+ * \param[in] dev is the device.
+ *
+ * \return The health, DEV_HEALTH_UNKNOWN before the first use.
+ */
+enum dev_health_state blackboard_get_health(enum blackboard_dev dev);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CHECKSUM_H_
+#define CHECKSUM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Checksums of the device protocols: the CRC-8 (polynomial 0x07, initial
+ * value 0, no reflection) of the EPS 2.0 and TTC 2.0 packets, and the XOR
+ * of all bytes of the EDC frames. Both can be computed in pieces, by
+ * passing the value returned for a piece to the update of the next one.
+ */
+
+#define CHECKSUM_CRC8_INIT 0x00U
+
+/* Shorter buffers are not worth the slice-by-8 setup */
+#define CHECKSUM_SLICE_MIN_LEN 16U
+
+/**
+ * \brief Computes the CRC-8 of a buffer.
+ *
+ * \param[in] data is the buffer.
+ *
+ * \param[in] len is the number of bytes of the buffer.
+ *
+ * \return The CRC-8 of the buffer.
+ */
+uint8_t checksum_crc8(const uint8_t *data, size_t len);
+
+/**
+ * \brief Adds bytes to a CRC-8.
+ *
+ * \param[in] crc is the CRC-8 of the previous bytes, or CHECKSUM_CRC8_INIT.
+ *
+ * \param[in] data is the buffer.
+ *
+ * \param[in] len is the number of bytes of the buffer.
+ *
+ * \return The CRC-8 of the previous bytes followed by the buffer.
+ */
+uint8_t checksum_crc8_update(uint8_t crc, const uint8_t *data, size_t len);
+
+/**
+ * \brief Computes the XOR of all bytes of a buffer.
+ *
+ * \param[in] data is the buffer.
+ *
+ * \param[in] len is the number of bytes of the buffer.
+ *
+ * \return The XOR of the bytes.
+ */
+uint8_t checksum_xor8(const uint8_t *data, size_t len);
+
+/**
+ * \brief Adds bytes to a XOR checksum.
+ *
+ * \param[in] sum is the checksum of the previous bytes, or 0.
+ *
+ * \param[in] data is the buffer.
+ *
+ * \param[in] len is the number of bytes of the buffer.
+ *
+ * \return The checksum of the previous bytes followed by the buffer.
+ */
+uint8_t checksum_xor8_update(uint8_t sum, const uint8_t *data, size_t len);
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef CMD_SERVER_H_
+#define CMD_SERVER_H_
+
+#include <stdint.h>
+
+/*
+ * The command server binds a ZMQ ROUTER socket, so it answers both REQ and
+ * DEALER clients. A request is a single frame made of a cmd_server_req_hdr
+ * followed by count cmd_server_item; the reply is a cmd_server_rep_hdr
+ * followed by one cmd_server_result per item, in the same order. All fields
+ * are little-endian.
+ *
+ * The whole batch runs while holding the locks of the devices it touches, so
+ * no telemetry thread can access them between two items.
+ *
+ * A request whose version is CMD_SERVER_QUERY_VERSION is a single
+ * cmd_server_query instead. Its reply is a cmd_server_rep_hdr, with count
+ * set to the number of entries that follow, see enum cmd_server_query_op.
+ *
+ * Queries extend the batch protocol without changing it: a version 1 client
+ * keeps working, and a server predating them answers a query with
+ * CMD_SERVER_ERR_INVALID. The first one, CMD_SERVER_QUERY_LOG_LEVEL, sets the
+ * runtime log levels of sys_log_set_level(); telemetry and PTT queries
+ * followed as new ops.
+ *
+ * CMD_SERVER_QUERY_VERSION changes with the layout of the query or of its
+ * entries, and a query of another version is rejected as invalid:
+ * - 0x81: the log level query, then the telemetry and PTT queries, which
+ *   added instance, from and to.
+ * - 0x82: from_number, to page through a scan by sample number.
+ */
+
+#define CMD_SERVER_VERSION 1U
+#define CMD_SERVER_QUERY_VERSION 0x82U
+
+/* Largest number of items in a batch */
+#define CMD_SERVER_ITEMS_MAX 64U
+
+enum cmd_server_op {
+	CMD_SERVER_OP_READ, /**< Reads the register adr into value. */
+	CMD_SERVER_OP_WRITE, /**< Writes value to the register adr. */
+	CMD_SERVER_OP_EXEC, /**< Payload command adr with value as argument. */
+};
+
+enum cmd_server_dev {
+	CMD_SERVER_DEV_EPS, /**< eps_set_param()/eps_get_param(). */
+	CMD_SERVER_DEV_TTC, /**< ttc_set_param()/ttc_get_param(). */
+	CMD_SERVER_DEV_EDC, /**< payload_write_cmd() on the payload instance. */
+};
+
+enum cmd_server_status {
+	CMD_SERVER_OK = 0,
+	CMD_SERVER_ERR_DEVICE = -1, /**< The device call failed. */
+	CMD_SERVER_ERR_INVALID = -2, /**< Unknown op, device or instance. */
+};
+
+struct cmd_server_req_hdr {
+	uint8_t version;
+	uint8_t count; /**< Number of items, up to CMD_SERVER_ITEMS_MAX. */
+	uint16_t seq; /**< Echoed in the reply. */
+};
+
+struct cmd_server_item {
+	uint8_t op; /**< One of enum cmd_server_op. */
+	uint8_t dev; /**< One of enum cmd_server_dev. */
+	uint8_t instance; /**< TTC radio or payload id. */
+	uint8_t adr; /**< Register address or payload command. */
+	uint32_t value;
+};
+
+struct cmd_server_rep_hdr {
+	uint8_t version;
+	uint8_t count;
+	uint16_t seq;
+	int32_t status; /**< CMD_SERVER_ERR_INVALID if the request is malformed. */
+};
+
+struct cmd_server_result {
+	int32_t status; /**< One of enum cmd_server_status. */
+	uint32_t value; /**< Value read, 0 for writes. */
+};
+
+enum cmd_server_query_op {
+	CMD_SERVER_QUERY_LOG_LEVEL, /**< Sets the level arg of the module name,
+				      or the default level if empty, no
+				      entries. */
+	CMD_SERVER_QUERY_TM_SCAN, /**< Samples of the field name in the window,
+				    from the sample from_number, oldest
+				    first, as cmd_server_sample. */
+	CMD_SERVER_QUERY_TM_AGG, /**< Aggregate of the field name in the window,
+				   as one cmd_server_agg. */
+	CMD_SERVER_QUERY_PTT_POP, /**< Takes up to arg PTT packets from the
+				    queue, all if 0, oldest first, as raw
+				    edc_ptt_t in host byte order. There is
+				    no acknowledgement: the packets leave
+				    the queue with the reply, and are lost
+				    if it does not reach the client. */
+};
+
+/* Largest number of entries in a query reply, longer scans are paged by sample number */
+#define CMD_SERVER_QUERY_ENTRIES_MAX 128U
+
+/* Longest name in a query, including the terminating null */
+#define CMD_SERVER_QUERY_NAME_MAX 32U
+
+struct cmd_server_query {
+	uint8_t version; /**< CMD_SERVER_QUERY_VERSION. */
+	uint8_t op; /**< One of enum cmd_server_query_op. */
+	uint16_t seq; /**< Echoed in the reply. */
+	uint8_t arg; /**< Level, or enum tm_pub_type of the series. */
+	uint8_t instance; /**< Device index of the series, e.g. the TTC radio. */
+	uint8_t reserved[2];
+	char name[CMD_SERVER_QUERY_NAME_MAX]; /**< Module or field, see op. */
+	uint64_t from; /**< Start of the window, in microseconds, included. */
+	uint64_t to; /**< End of the window, in microseconds, included. */
+	uint64_t from_number; /**< First sample number of a scan, one after
+				the last of the previous page, 0 for the
+				first page. */
+};
+
+struct cmd_server_sample {
+	uint64_t number; /**< Sample number in its series, one more than the
+			   previous sample. */
+	uint64_t timestamp; /**< Realtime clock, in microseconds. */
+	int64_t value;
+};
+
+struct cmd_server_agg {
+	uint32_t count; /**< Samples in the window, the rest is 0 if none. */
+	uint32_t reserved;
+	int64_t min;
+	int64_t max;
+	uint64_t mean; /**< Bits of an IEEE 754 double. */
+};
+
+/**
+ * \brief Command server thread.
+ *
+ * Binds OBDH2_SIM_CMD_ENDPOINT and serves batches until the process exits.
+ *
+ * \param[in] arg is unused.
+ *
+ * \return NULL if the socket can't be created.
+ */
+void *cmd_server_thread(void *arg);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef DEV_HEALTH_H_
+#define DEV_HEALTH_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Health of a device, to skip the probes of a device known to work and to
+ * stop spending bus time on one known to be dead. A device starts unknown
+ * and is probed (initialized or checked) before its first use. A success
+ * makes it ready, and a ready device is used without probing. An error
+ * makes it degraded, so the next use probes it again. After
+ * DEV_HEALTH_FAILURES_MAX errors in a row the circuit opens: the device is
+ * offline and left alone until its backoff ends, then probed by a single
+ * caller, the backoff doubling each time the probe fails.
+ */
+
+#define DEV_HEALTH_FAILURES_MAX 3U
+
+#define DEV_HEALTH_BACKOFF_MIN_MS 30000U
+
+#define DEV_HEALTH_BACKOFF_MAX_MS 900000U
+
+enum dev_health_state {
+	DEV_HEALTH_UNKNOWN = 0,
+	DEV_HEALTH_READY,
+	DEV_HEALTH_DEGRADED,
+	DEV_HEALTH_OFFLINE,
+};
+
+/* What the caller of dev_health_begin() should do */
+enum dev_health_action {
+	DEV_HEALTH_USE = 0, /**< Use the device directly. */
+	DEV_HEALTH_PROBE, /**< Probe the device before using it. */
+	DEV_HEALTH_SKIP, /**< Leave the device alone. */
+};
+
+/* Publishes a new state of a device, called with its health locked */
+typedef void (*dev_health_publish_t)(enum dev_health_state state);
+
+struct dev_health {
+	const char *name;
+	dev_health_publish_t publish; /**< NULL if the state is not published. */
+	enum dev_health_state state;
+	unsigned int failures; /**< Errors in a row. */
+	uint32_t backoff_ms;
+	uint64_t retry_ms; /**< Monotonic time of the next probe when offline. */
+	pthread_mutex_t lock;
+};
+
+#define DEV_HEALTH_INIT(n, pub)                                                \
+	{                                                                      \
+		.name = (n), .publish = (pub), .state = DEV_HEALTH_UNKNOWN,    \
+		.lock = PTHREAD_MUTEX_INITIALIZER,                             \
+	}
+
+/**
+ * \brief Tells what to do before using a device.
+ *
+ * \param[in,out] health is the health of the device.
+ *
+ * \return DEV_HEALTH_USE, DEV_HEALTH_PROBE or DEV_HEALTH_SKIP.
+ */
+enum dev_health_action dev_health_begin(struct dev_health *health);
+
+/**
+ * \brief Reports the outcome of a probe or of an operation on a device.
+ *
+ * \param[in,out] health is the health of the device.
+ *
+ * \param[in] ok is true on success.
+ */
+void dev_health_report(struct dev_health *health, bool ok);
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef EVLOOP_H_
+#define EVLOOP_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <system/task_stats.h>
+
+/*
+ * Periodic tasks are split into steps. A step returns EVLOOP_TASK_DONE when
+ * the cycle is over, or a delay in milliseconds after which the next step
+ * runs, instead of sleeping. The same task runs either on its own thread
+ * (evloop_task_thread()) or with the others on the event loop
+ * (evloop_thread()), which picks due tasks from a timer heap in deadline,
+ * then priority, then registration order. A task may also be triggered,
+ * to react to an event without waiting for its next period.
+ *
+ * The event loop runtime is experimental: the device drivers still sleep
+ * inside a step, for the timing polls of dev_timing_wait(), the EDC command
+ * delays and the TTC turnarounds, so one slow device stalls all the tasks
+ * sharing the loop thread. Only the waits between steps are given back.
+ */
+
+#define EVLOOP_TASK_DONE 0
+
+/* Largest number of tasks on the event loop */
+#define EVLOOP_TASKS_MAX 16U
+
+struct evloop_task;
+
+typedef int (*evloop_step_t)(struct evloop_task *task);
+
+struct evloop_task {
+	const char *name;
+	uint32_t period_ms;
+	uint32_t deadline_ms; /**< From the release, 0 means the period. */
+	uint8_t prio; /**< Lower runs first when tasks are due together. */
+	evloop_step_t step;
+	void *arg;
+
+	/* Reset to 0 at each release, free for the steps to use */
+	unsigned int state;
+	unsigned int iter;
+
+	/* Owned by the runtime */
+	uint64_t release; /**< Monotonic time of the current cycle, in ns. */
+	uint64_t due; /**< Monotonic time of the next step, in ns. */
+	uint64_t start; /**< Time of the first step of the cycle, 0 before. */
+	unsigned int seq;
+	atomic_bool triggered; /**< Next cycle to be released early. */
+	struct task_stats stats;
+	bool threaded; /**< Waits on wake, on its own thread. */
+	pthread_cond_t wake;
+};
+
+/**
+ * \brief Adds a task to the event loop.
+ *
+ * May be called before or while the loop runs. The first cycle is released
+ * immediately.
+ *
+ * \param[in] task is the task, which must outlive the loop.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int evloop_add(struct evloop_task *task);
+
+/**
+ * \brief Event loop thread.
+ *
+ * Waits on a timerfd armed for the earliest task in the heap and runs its
+ * steps, until evloop_stop() is called.
+ *
+ * \param[in] arg is unused.
+ *
+ * \return NULL.
+ */
+void *evloop_thread(void *arg);
+
+/**
+ * \brief Stops the event loop after the current step.
+ */
+void evloop_stop(void);
+
+/**
+ * \brief Releases the next cycle of a task now, instead of at its period.
+ *
+ * A task in the middle of a cycle starts the next one as soon as the
+ * current one ends. The period restarts from the triggered cycle. Works on
+ * either runtime, from any thread.
+ *
+ * \param[in] task is the task.
+ */
+void evloop_trigger(struct evloop_task *task);
+
+/**
+ * \brief Runs a single task on the calling thread, forever.
+ *
+ * \param[in] arg is the struct evloop_task to run.
+ *
+ * \return NULL.
+ */
+void *evloop_task_thread(void *arg);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PTT_QUEUE_H_
+#define PTT_QUEUE_H_
+
+#include <stddef.h>
+
+#include <drivers/edc.h>
+
+/*
+ * Bounded queue of the PTT packets decoded from the EDC, filled by the EDC
+ * task and emptied through the command server (CMD_SERVER_QUERY_PTT_POP).
+ * When full, the oldest packet is dropped to make room, as the newest
+ * packets are the ones still useful to downlink.
+ */
+
+/* Packets kept, as deep as the PTT FIFO of the EDC */
+#define PTT_QUEUE_CAPACITY 64U
+
+/**
+ * \brief Appends a packet, dropping the oldest one if the queue is full.
+ *
+ * \param[in] ptt is the packet.
+ *
+ * \return 0 on success, -1 if the oldest packet was dropped.
+ */
+int ptt_queue_push(const edc_ptt_t *ptt);
+
+/**
+ * \brief Takes the oldest packets.
+ *
+ * \param[out] ptt is an array to store the packets, oldest first.
+ *
+ * \param[in] max is the size of the array.
+ *
+ * \return The number of packets taken, 0 if the queue is empty.
+ */
+size_t ptt_queue_pop(edc_ptt_t *ptt, size_t max);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Sequence lock over a plain integer, so it can live in memory shared with
+ * other processes. The writer makes the sequence odd while it changes the
+ * data, and readers copy the data without locking and retry if the
+ * sequence was odd or changed meanwhile. Writers of the same data must be
+ * serialized by the caller, readers never block them.
+ */
+
+/**
+ * \brief Starts changing the data.
+ *
+ * \param[in,out] seq is the sequence of the data.
+ */
+static inline void seqlock_write_begin(uint32_t *seq)
+{
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1U,
+			 __ATOMIC_RELAXED);
+
+	/* The odd sequence must be visible before any change to the data */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Ends changing the data.
+ *
+ * \param[in,out] seq is the sequence of the data.
+ */
+static inline void seqlock_write_end(uint32_t *seq)
+{
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1U,
+			 __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Starts reading the data.
+ *
+ * \param[in] seq is the sequence of the data.
+ *
+ * \return The sequence, to pass to seqlock_read_retry().
+ */
+static inline uint32_t seqlock_read_begin(const uint32_t *seq)
+{
+	return __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * \brief Checks whether the data read since seqlock_read_begin() may be
+ * torn.
+ *
+ * \param[in] seq is the sequence of the data.
+ *
+ * \param[in] start is the value returned by seqlock_read_begin().
+ *
+ * \return true if the data was being written, and must be read again.
+ */
+static inline bool seqlock_read_retry(const uint32_t *seq, uint32_t start)
+{
+	/* The copy must be complete before the sequence is checked again */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return ((start & 1U) != 0U) ||
+	       (__atomic_load_n(seq, __ATOMIC_RELAXED) != start);
+}
+
+#endif
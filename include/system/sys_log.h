@@ -1,16 +1,164 @@
 #ifndef SYS_LOG_H_
 #define SYS_LOG_H_
 
+#include <stdatomic.h>
+#include <stdbool.h>
+
 enum sys_log_level {
 	SYS_LOG_ERROR,
 	SYS_LOG_WARNING,
 	SYS_LOG_INFO,
 };
 
+enum sys_log_format {
+	SYS_LOG_FORMAT_TEXT,
+	SYS_LOG_FORMAT_BINARY,
+};
+
+/* Most verbose level compiled in, set by the log_level meson option */
+#ifndef SYS_LOG_COMPILE_LEVEL
+#define SYS_LOG_COMPILE_LEVEL SYS_LOG_INFO
+#endif
+
+/* Level of a call site that is not resolved, or logs for several modules */
+#define SYS_LOG_SITE_ANY (SYS_LOG_INFO + 1)
+
+/*
+ * Call site of sys_log_print_event_from_module(), holding the runtime level
+ * of its module. The level is resolved by the first call and updated by
+ * sys_log_set_level(). Owned by sys_log.
+ */
+struct sys_log_site {
+	int level; /**< Accessed with the __atomic builtins. */
+	const char *module; /**< NULL once several were seen. */
+	bool registered;
+	bool mixed;
+	struct sys_log_site *next;
+};
+
+#define SYS_LOG_SITE_INIT { .level = SYS_LOG_SITE_ANY }
+
 int sys_log_set_log_file(const char *filename);
 
 int sys_log_print_event_from_module(int level, const char *module, const char *format, ...);
 
+int sys_log_print_event_from_site(struct sys_log_site *site, int level,
+				  const char *module, const char *format, ...);
+
+static inline int sys_log_filtered(void)
+{
+	return 0;
+}
+
+/*
+ * Filters messages before their arguments are evaluated: calls above the
+ * compile-time level are removed, and the rest cost one branch when above
+ * the runtime level of the module of their call site.
+ */
+#define sys_log_print_event_from_module(lvl, mod, ...)                        \
+	__extension__({                                                        \
+		static struct sys_log_site sys_log_site_ = SYS_LOG_SITE_INIT;  \
+		(((lvl) <= SYS_LOG_COMPILE_LEVEL) &&                           \
+		 ((lvl) <= __atomic_load_n(&sys_log_site_.level,               \
+					   __ATOMIC_RELAXED))) ?               \
+			sys_log_print_event_from_site(&sys_log_site_, lvl, mod, \
+						      __VA_ARGS__) :           \
+			sys_log_filtered();                                    \
+	})
+
+/**
+ * \brief Sets the runtime log level of a module.
+ *
+ * Messages above the level of their module are discarded. Modules without
+ * their own level use the default one.
+ *
+ * \param[in] module is the module name, or NULL to set the default level.
+ *
+ * \param[in] level is the most verbose level to print.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_set_level(const char *module, int level);
+
 int sys_log_print_msg(const char *format, ...);
 
+/**
+ * \brief Sets the rate limit of error and warning messages.
+ *
+ * Each module and format string pair has its own token bucket: up to burst
+ * identical messages are printed in a row, then one per interval. The
+ * number of suppressed messages is reported with the next one printed, or
+ * by the asynchronous writer once the burst stops.
+ *
+ * \param[in] burst is the bucket size, 0 disables rate limiting.
+ *
+ * \param[in] interval_ms is the refill interval of one token.
+ */
+void sys_log_set_rate_limit(unsigned int burst, unsigned int interval_ms);
+
+/**
+ * \brief Reopens the log file, e.g. after it was rotated.
+ *
+ * The log file is kept open between messages, so it must be reopened for
+ * a rotated file to be released. If no log file is open, e.g. because it
+ * could not be opened before, it is opened. Must not be called from a
+ * signal handler.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_reopen(void);
+
+/**
+ * \brief Sets the format of the log output.
+ *
+ * In binary mode each message is written as a compact record holding a format
+ * ID, a timestamp and the raw arguments (see system/sys_log_bin.h). The text
+ * is only rendered offline, by obdh2-log-decode.
+ *
+ * \param[in] format is SYS_LOG_FORMAT_TEXT or SYS_LOG_FORMAT_BINARY.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_set_format(int format);
+
+/**
+ * \brief Starts the asynchronous logging backend.
+ *
+ * After this call, log messages are formatted by the caller into a lock-free
+ * ring buffer and written to the log file by a dedicated writer thread. When
+ * the ring is full the message is dropped and accounted for.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_start_async(void);
+
+/**
+ * \brief Drains the ring buffer and stops the writer thread.
+ */
+void sys_log_stop_async(void);
+
+/**
+ * \brief Gets the number of messages dropped because the ring buffer was full.
+ *
+ * \return The number of dropped messages since the backend was started.
+ */
+unsigned long sys_log_get_dropped(void);
+
+/**
+ * \brief Starts the flight recorder.
+ *
+ * Every message is also written, as text, to a ring of fixed-size slots in a
+ * memory-mapped file. The entries survive a crash of the process without any
+ * fsync, and can be extracted with obdh2-log-rec-dump. An existing recorder
+ * file with the same geometry is appended to, so the events that led to a
+ * crash are kept across the restart.
+ *
+ * \param[in] path is the recorder file.
+ *
+ * \param[in] slots is the number of entries kept in the ring.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_start_recorder(const char *path, unsigned int slots);
+
 #endif
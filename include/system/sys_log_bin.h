@@ -0,0 +1,197 @@
+#ifndef SYS_LOG_BIN_H_
+#define SYS_LOG_BIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Binary log stream layout. Every record starts with a sys_log_bin_hdr and
+ * all multi-byte fields are stored in host (little-endian) byte order.
+ *
+ *  SESSION: hdr, u32 magic, u16 version, u64 timestamp (us)
+ *  FMT:     hdr, u16 id, u8 nargs, u8 module len, u16 format len,
+ *           u8 arg types[nargs], module, format
+ *  EVENT:   hdr, u16 id, u64 timestamp (us), raw args
+ *  TEXT:    hdr, u64 timestamp (us), u8 module len, module, text
+ *
+ * Plain int args are stored as 4 bytes, every wider integer (long, long
+ * long, size_t, pointers) as 8 bytes, doubles as 8 bytes and strings as a u8
+ * length followed by the bytes (no terminator).
+ */
+
+#define SYS_LOG_BIN_MAGIC 0x474C424FU /**< "OBLG" */
+#define SYS_LOG_BIN_VERSION 1U
+
+#define SYS_LOG_BIN_MAX_ARGS 8U
+#define SYS_LOG_BIN_MAX_SITES 256U
+
+enum sys_log_bin_rec {
+	SYS_LOG_BIN_REC_SESSION = 0x53,
+	SYS_LOG_BIN_REC_FMT = 0x46,
+	SYS_LOG_BIN_REC_EVENT = 0x45,
+	SYS_LOG_BIN_REC_TEXT = 0x54,
+};
+
+enum sys_log_bin_arg {
+	SYS_LOG_BIN_ARG_INVALID = 0,
+	SYS_LOG_BIN_ARG_INT,
+	SYS_LOG_BIN_ARG_LONG,
+	SYS_LOG_BIN_ARG_LLONG,
+	SYS_LOG_BIN_ARG_SIZE,
+	SYS_LOG_BIN_ARG_PTR,
+	SYS_LOG_BIN_ARG_DOUBLE,
+	SYS_LOG_BIN_ARG_STR,
+};
+
+/**
+ * \brief Gets the size an argument takes in an EVENT record.
+ *
+ * \param[in] type is the argument type.
+ *
+ * \return The size in bytes, 0 for strings (variable length).
+ */
+static inline size_t sys_log_bin_arg_size(uint8_t type)
+{
+	if (type == SYS_LOG_BIN_ARG_INT)
+		return 4U;
+
+	if (type == SYS_LOG_BIN_ARG_STR)
+		return 0U;
+
+	return 8U;
+}
+
+struct sys_log_bin_hdr {
+	uint8_t type;
+	uint8_t level;
+	uint16_t len; /**< Record length, including this header. */
+};
+
+/**
+ * \brief A single printf conversion found in a format string.
+ */
+struct sys_log_bin_conv {
+	const char *start; /**< Points to the '%'. */
+	uint8_t len; /**< Length of the whole conversion spec. */
+	uint8_t star; /**< Number of '*' width/precision args. */
+	uint8_t type; /**< Type of the converted argument. */
+};
+
+/**
+ * \brief Finds the next argument-consuming conversion of a format string.
+ *
+ * Literal "%%" and a dangling '%' at the end of the string are skipped.
+ *
+ * \param[in] fmt is the format string to scan.
+ *
+ * \param[out] conv is the conversion found.
+ *
+ * \return A pointer past the conversion, NULL if there are no more.
+ */
+static inline const char *sys_log_bin_next_conv(const char *fmt,
+						struct sys_log_bin_conv *conv)
+{
+	while ((fmt = strchr(fmt, '%')) != NULL) {
+		const char *p = fmt + 1;
+		uint8_t type = SYS_LOG_BIN_ARG_INT;
+
+		if (*p == '%') {
+			fmt = p + 1;
+			continue;
+		}
+
+		conv->start = fmt;
+		conv->star = 0U;
+
+		while ((*p != '\0') && (strchr("-+ #0'", *p) != NULL))
+			p++;
+
+		for (int i = 0; i < 2; ++i) {
+			if (*p == '*') {
+				conv->star++;
+				p++;
+			}
+
+			while ((*p >= '0') && (*p <= '9'))
+				p++;
+
+			if (*p != '.')
+				break;
+
+			p++;
+		}
+
+		while ((*p != '\0') && (strchr("hlLqjzt", *p) != NULL)) {
+			switch (*p) {
+			case 'l':
+				type = (type == SYS_LOG_BIN_ARG_INT) ?
+					       SYS_LOG_BIN_ARG_LONG :
+					       SYS_LOG_BIN_ARG_LLONG;
+				break;
+			case 'q':
+			case 'j':
+				type = SYS_LOG_BIN_ARG_LLONG;
+				break;
+			case 'z':
+			case 't':
+				type = SYS_LOG_BIN_ARG_SIZE;
+				break;
+			case 'L':
+				type = SYS_LOG_BIN_ARG_INVALID;
+				break;
+			default:
+				break;
+			}
+			p++;
+		}
+
+		if (*p == '\0')
+			return NULL;
+
+		switch (*p) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			conv->type = type;
+			break;
+		case 'c':
+			conv->type = SYS_LOG_BIN_ARG_INT;
+			break;
+		case 'p':
+			conv->type = SYS_LOG_BIN_ARG_PTR;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			conv->type = (type == SYS_LOG_BIN_ARG_INVALID) ?
+					     SYS_LOG_BIN_ARG_INVALID :
+					     SYS_LOG_BIN_ARG_DOUBLE;
+			break;
+		case 's':
+			conv->type = (type == SYS_LOG_BIN_ARG_INT) ?
+					     SYS_LOG_BIN_ARG_STR :
+					     SYS_LOG_BIN_ARG_INVALID;
+			break;
+		default:
+			conv->type = SYS_LOG_BIN_ARG_INVALID;
+			break;
+		}
+
+		conv->len = (uint8_t)(p + 1 - fmt);
+
+		return p + 1;
+	}
+
+	return NULL;
+}
+
+#endif
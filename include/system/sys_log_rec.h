@@ -0,0 +1,40 @@
+#ifndef SYS_LOG_REC_H_
+#define SYS_LOG_REC_H_
+
+#include <stdint.h>
+
+/*
+ * Flight recorder file layout: a header page followed by a ring of fixed-size
+ * slots holding log entries in the format of the log: text lines, or binary
+ * records (see sys_log_bin.h) whose FMT records are only in the log file.
+ *
+ * Entry i lives in slot (i % slots). A writer claims i by incrementing head,
+ * clears the slot seq, fills it in and commits it by storing seq = i + 1. An
+ * entry is valid only while its seq matches, so slots torn by a crash or
+ * being rewritten are skipped by readers.
+ */
+
+#define SYS_LOG_REC_MAGIC 0x43524C53U /**< "SLRC" */
+#define SYS_LOG_REC_VERSION 1U
+
+#define SYS_LOG_REC_HDR_SIZE 4096U
+#define SYS_LOG_REC_DATA_MAX 256U
+
+struct sys_log_rec_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t slot_size;
+	uint32_t slots;
+	uint64_t head; /**< Index of the next entry to be written. */
+	uint64_t tail; /**< Index of the oldest entry still in the ring. */
+};
+
+struct sys_log_rec_slot {
+	uint64_t seq;
+	uint32_t len;
+	uint32_t format; /**< enum sys_log_format of data. */
+	char data[SYS_LOG_REC_DATA_MAX];
+};
+
+#endif
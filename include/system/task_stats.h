@@ -0,0 +1,75 @@
+#ifndef TASK_STATS_H_
+#define TASK_STATS_H_
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Log-linear histograms of nanosecond values: values below 2^SUB_BITS get
+ * a bucket each, then every power of two is split in 2^SUB_BITS buckets,
+ * which bounds the error of any percentile to 1/2^SUB_BITS. Recording is a
+ * relaxed atomic increment, so any thread may record and dump at once.
+ */
+
+#define TASK_STATS_SUB_BITS 4U
+
+#define TASK_STATS_SUB_COUNT (1U << TASK_STATS_SUB_BITS)
+
+#define TASK_STATS_BUCKETS \
+	((64U - TASK_STATS_SUB_BITS + 1U) * TASK_STATS_SUB_COUNT)
+
+struct task_stats_hist {
+	atomic_ulong count[TASK_STATS_BUCKETS];
+	atomic_uint_least64_t max;
+};
+
+struct task_stats {
+	struct task_stats_hist lateness; /**< Release to first step. */
+	struct task_stats_hist duration; /**< First step to end of the cycle. */
+	atomic_ulong cycles;
+	atomic_ulong overruns; /**< Cycles ending after their deadline. */
+	const char *name;
+	struct task_stats *next;
+};
+
+/**
+ * \brief Adds a value to a histogram.
+ *
+ * \param[in] hist is the histogram.
+ *
+ * \param[in] ns is the value, in nanoseconds.
+ */
+void task_stats_record(struct task_stats_hist *hist, uint64_t ns);
+
+/**
+ * \brief Gets a percentile of a histogram.
+ *
+ * \param[in] hist is the histogram.
+ *
+ * \param[in] pct is the percentile, from 0 to 100.
+ *
+ * \return The upper bound of the bucket holding the percentile, at most the
+ * largest value recorded, in ns.
+ */
+uint64_t task_stats_percentile(const struct task_stats_hist *hist,
+			       unsigned int pct);
+
+/**
+ * \brief Adds the stats of a task to the list printed by task_stats_dump().
+ *
+ * \param[in] stats are the stats, which must live until the process exits.
+ *
+ * \param[in] name is the name of the task.
+ */
+void task_stats_register(struct task_stats *stats, const char *name);
+
+/**
+ * \brief Logs the cycle count, overruns and lateness and duration
+ * percentiles of every registered task.
+ *
+ * The report bypasses the log levels and the rate limit, so it is printed
+ * even when built with -Dlog_level=error.
+ */
+void task_stats_dump(void);
+
+#endif
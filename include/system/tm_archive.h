@@ -0,0 +1,175 @@
+#ifndef TM_ARCHIVE_H_
+#define TM_ARCHIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/tm_pub.h>
+
+/*
+ * Append-only archive of the fixed-layout telemetry samples (the EPS data,
+ * the TTC HK data and the EDC HK), partitioned in one file per UTC day,
+ * named YYYYMMDD.tma. All multi-byte fields are stored in host
+ * (little-endian) byte order.
+ *
+ *  FILE:   tm_archive_file_hdr, then records
+ *  RECORD: tm_archive_rec_hdr, body, tm_archive_rec_end
+ *  SCHEMA: per field: u8 kind (enum tm_field_kind), u8 name len, name
+ *  BLOCK:  u32 count, u64 first timestamp, u64 last timestamp,
+ *          timestamp column, one column per field,
+ *          u32 offset[nfields + 1] of each column from the record start
+ *
+ * The SCHEMA of a series is written before its first BLOCK in each file,
+ * so every file can be read on its own. A BLOCK holds up to
+ * TM_ARCHIVE_BLOCK_SAMPLES samples as columns of zigzag varints: the
+ * timestamps as deltas of deltas (from the first timestamp, the first delta
+ * being 0) and each field as deltas from the previous sample (the first
+ * from 0). The offsets at the end of a block give each column without
+ * decoding the others. A record torn by a crash fails the
+ * tm_archive_rec_end check, and the writer drops it when reopening the file.
+ */
+
+#define TM_ARCHIVE_MAGIC 0x414D544FU /**< "OTMA" */
+#define TM_ARCHIVE_VERSION 1U
+
+#define TM_ARCHIVE_REC_MAGIC 0x45414D54U /**< "TMAE" */
+
+#define TM_ARCHIVE_BLOCK_SAMPLES 64U
+
+/* Longest varint of a 64-bit value */
+#define TM_ARCHIVE_VARINT_MAX 10U
+
+enum tm_archive_rec {
+	TM_ARCHIVE_REC_SCHEMA = 0x53,
+	TM_ARCHIVE_REC_BLOCK = 0x42,
+};
+
+struct tm_archive_file_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint64_t day; /**< Start of the day, in microseconds since the epoch. */
+};
+
+struct tm_archive_rec_hdr {
+	uint32_t len; /**< Record length, including the header and the end. */
+	uint8_t rec;
+	uint8_t type; /**< enum tm_pub_type of the series. */
+	uint8_t instance;
+	uint8_t nfields;
+};
+
+struct tm_archive_rec_end {
+	uint32_t len; /**< Same as in the header. */
+	uint32_t magic;
+};
+
+/**
+ * \brief Maps a signed value to an unsigned one, small magnitudes first.
+ */
+static inline uint64_t tm_archive_zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+/**
+ * \brief Inverse of tm_archive_zigzag().
+ */
+static inline int64_t tm_archive_unzigzag(uint64_t v)
+{
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1U);
+}
+
+/**
+ * \brief Writes a varint, 7 bits per byte, least significant first.
+ *
+ * \param[out] p is the buffer, with room for TM_ARCHIVE_VARINT_MAX bytes.
+ *
+ * \param[in] v is the value.
+ *
+ * \return The number of bytes written.
+ */
+static inline size_t tm_archive_put_varint(uint8_t *p, uint64_t v)
+{
+	size_t n = 0U;
+
+	while (v >= 0x80U) {
+		p[n++] = (uint8_t)(v | 0x80U);
+		v >>= 7;
+	}
+
+	p[n++] = (uint8_t)v;
+
+	return n;
+}
+
+/**
+ * \brief Reads a varint.
+ *
+ * \param[in] p is the buffer.
+ *
+ * \param[in] end is the end of the buffer.
+ *
+ * \param[out] v is the value.
+ *
+ * \return The number of bytes read, 0 if the varint is truncated or too
+ * long.
+ */
+static inline size_t tm_archive_get_varint(const uint8_t *p,
+					   const uint8_t *end, uint64_t *v)
+{
+	uint64_t val = 0U;
+
+	for (size_t n = 0U; (n < TM_ARCHIVE_VARINT_MAX) && (p + n < end); ++n) {
+		val |= (uint64_t)(p[n] & 0x7FU) << (7U * n);
+
+		if ((p[n] & 0x80U) == 0U) {
+			*v = val;
+			return n + 1U;
+		}
+	}
+
+	return 0U;
+}
+
+/**
+ * \brief Opens the archive.
+ *
+ * \param[in] dir is the directory of the day files, created if missing.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_archive_open(const char *dir);
+
+/**
+ * \brief Appends a telemetry sample to the block of its series.
+ *
+ * The block is written out when full, when the day changes, or when its
+ * oldest sample is a few minutes old, so a slow series is not held in
+ * memory for long. Does nothing if the archive is not open.
+ *
+ * \param[in] type is the type of the telemetry: TM_PUB_EPS_DATA,
+ * TM_PUB_TTC_DATA or TM_PUB_EDC_HK.
+ *
+ * \param[in] instance is the device index, e.g. the TTC radio.
+ *
+ * \param[in] data is the telemetry structure.
+ *
+ * \param[in] size is the size of data, which must match the type.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_archive_append(enum tm_pub_type type, uint8_t instance,
+		      const void *data, size_t size);
+
+/**
+ * \brief Writes out the pending blocks, as partial blocks.
+ */
+void tm_archive_sync(void);
+
+/**
+ * \brief Writes out the pending blocks and closes the archive.
+ */
+void tm_archive_close(void);
+
+#endif
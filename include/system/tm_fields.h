@@ -0,0 +1,75 @@
+#ifndef TM_FIELDS_H_
+#define TM_FIELDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/tm_pub.h>
+
+/*
+ * Description of the scalar fields of the fixed-layout telemetry structures
+ * (the EPS data, the TTC HK data and the EDC HK), to handle them as columns
+ * of integers. The kinds are stored in the telemetry archive, so their
+ * values must not change.
+ */
+
+/* Number of fields of each described structure */
+#define TM_FIELDS_EPS 46U
+#define TM_FIELDS_TTC 17U
+#define TM_FIELDS_EDC_HK 11U
+
+#define TM_FIELDS_MAX TM_FIELDS_EPS
+
+enum tm_field_kind {
+	TM_FIELD_U8 = 0,
+	TM_FIELD_I8,
+	TM_FIELD_U16,
+	TM_FIELD_I16,
+	TM_FIELD_U32,
+	TM_FIELD_I32,
+};
+
+struct tm_field {
+	const char *name; /**< Name of the member of the structure. */
+	size_t offset;
+	enum tm_field_kind kind;
+};
+
+/**
+ * \brief Gets the fields of a telemetry type.
+ *
+ * \param[in] type is the type of the telemetry: TM_PUB_EPS_DATA,
+ * TM_PUB_TTC_DATA or TM_PUB_EDC_HK.
+ *
+ * \param[out] nfields is the number of fields.
+ *
+ * \param[out] size is the size of the telemetry structure, may be NULL.
+ *
+ * \return The fields, NULL if the type has no fixed layout.
+ */
+const struct tm_field *tm_fields_get(enum tm_pub_type type,
+				     unsigned int *nfields, size_t *size);
+
+/**
+ * \brief Gets the index of a field by name.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] name is the name of the field, e.g. "battery_voltage".
+ *
+ * \return The index of the field, -1 if there is no such field.
+ */
+int tm_fields_find(enum tm_pub_type type, const char *name);
+
+/**
+ * \brief Reads a field of a telemetry structure.
+ *
+ * \param[in] data is the telemetry structure.
+ *
+ * \param[in] field is the field.
+ *
+ * \return The value of the field, widened.
+ */
+int64_t tm_fields_load(const void *data, const struct tm_field *field);
+
+#endif
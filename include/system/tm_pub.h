@@ -0,0 +1,116 @@
+#ifndef TM_PUB_H_
+#define TM_PUB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Telemetry is published on a ZMQ PUB socket as two-frame messages: the
+ * topic of the subsystem ("eps", "ttc", "edc" or "pos"), then a frame made
+ * of a tm_pub_hdr followed by the raw telemetry structure, in host byte
+ * order.
+ */
+
+#define TM_PUB_VERSION 1U
+
+/* Largest telemetry structure that can be published */
+#define TM_PUB_PAYLOAD_MAX 240U
+
+/* Number of pooled message buffers */
+#define TM_PUB_POOL_SIZE 32U
+
+enum tm_pub_type {
+	TM_PUB_EPS_DATA, /**< eps_data_t, topic "eps". */
+	TM_PUB_TTC_DATA, /**< ttc_data_t, topic "ttc". */
+	TM_PUB_EDC_HK, /**< edc_hk_t, topic "edc". */
+	TM_PUB_EDC_PTT, /**< edc_ptt_t, topic "edc". */
+	TM_PUB_ORBIT, /**< tm_pub_orbit_t, topic "pos". */
+	TM_PUB_TYPE_COUNT,
+};
+
+struct tm_pub_hdr {
+	uint8_t version;
+	uint8_t type; /**< One of enum tm_pub_type. */
+	uint8_t instance; /**< Device index, e.g. the TTC radio. */
+	uint8_t reserved;
+	uint32_t size; /**< Size of the payload following the header. */
+	uint64_t timestamp; /**< Realtime clock, in microseconds. */
+};
+
+/**
+ * \brief Gets the time of a telemetry sample.
+ *
+ * Used for the tm_pub_hdr timestamps and by every other telemetry sink, so
+ * the samples of all of them can be matched.
+ *
+ * \return The realtime clock, in microseconds.
+ */
+static inline uint64_t tm_pub_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000U) +
+	       ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+/**
+ * \brief Orbit solution from the position determination thread.
+ */
+typedef struct {
+	double julian_date;
+	float latitude; /**< Degrees. */
+	float longitude; /**< Degrees. */
+	float altitude; /**< Kilometers. */
+	uint8_t eclipsed;
+} tm_pub_orbit_t;
+
+/**
+ * \brief Creates the ZMQ context and binds the telemetry PUB socket.
+ *
+ * \param[in] endpoint is the endpoint to bind, e.g. "ipc:///tmp/obdh2-tm" or
+ * "inproc://tm".
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_pub_init(const char *endpoint);
+
+/**
+ * \brief Gets the ZMQ context of the publisher.
+ *
+ * Subscribers to an inproc:// endpoint must use the same context.
+ *
+ * \return The context, NULL if the publisher isn't initialized.
+ */
+void *tm_pub_get_context(void);
+
+/**
+ * \brief Publishes a telemetry structure.
+ *
+ * The structure is copied to a pooled buffer which is handed to ZMQ without
+ * further copies. Never blocks: the message is dropped if the pool is empty
+ * or the socket can't take it.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] instance is the device index.
+ *
+ * \param[in] data is the telemetry structure.
+ *
+ * \param[in] size is the size of data, up to TM_PUB_PAYLOAD_MAX.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_pub_send(enum tm_pub_type type, uint8_t instance, const void *data,
+		size_t size);
+
+/**
+ * \brief Gets the number of messages dropped.
+ *
+ * \return The number of dropped messages since the publisher was started.
+ */
+unsigned long tm_pub_get_dropped(void);
+
+#endif
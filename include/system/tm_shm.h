@@ -0,0 +1,73 @@
+#ifndef TM_SHM_H_
+#define TM_SHM_H_
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/tm_pub.h>
+
+/*
+ * Latest telemetry of each device, in a POSIX shared memory segment that
+ * other processes map read-only. The segment is a tm_shm_hdr, padded to
+ * hdr_size, followed by one tm_shm_rec per device, each guarded by its own
+ * seqlock (see seqlock.h): readers copy a record and retry if it changed
+ * meanwhile, so they never block the device threads nor make syscalls. The
+ * data is the same raw telemetry structure as published by tm_pub, in host
+ * byte order. Readers should use tm_shm_reader.h.
+ */
+
+#define TM_SHM_MAGIC 0x4853544FU /**< "OTSH" */
+#define TM_SHM_VERSION 1U
+
+#define TM_SHM_NAME "/obdh2-sim-tm"
+
+#define TM_SHM_HDR_SIZE 64U
+
+struct tm_shm_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t rec_size;
+	uint32_t records;
+};
+
+struct tm_shm_rec {
+	alignas(64) uint32_t seq; /**< Odd while the record is written. */
+	uint8_t type; /**< One of enum tm_pub_type. */
+	uint8_t instance; /**< Device index, e.g. the TTC radio. */
+	uint16_t size; /**< Size of data, 0 before the first sample. */
+	uint64_t timestamp; /**< Realtime clock, in microseconds. */
+	uint8_t data[TM_PUB_PAYLOAD_MAX];
+};
+
+/**
+ * \brief Creates the shared memory segment, or reuses the one left by a
+ * previous run.
+ *
+ * \param[in] name is the name of the segment, e.g. TM_SHM_NAME.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_shm_init(const char *name);
+
+/**
+ * \brief Replaces the latest telemetry of a device.
+ *
+ * Each device must be published from a single thread. Does nothing if the
+ * segment was not created.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] instance is the device index, e.g. the TTC radio.
+ *
+ * \param[in] data is the telemetry structure.
+ *
+ * \param[in] size is the size of data, at most TM_PUB_PAYLOAD_MAX.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int tm_shm_publish(enum tm_pub_type type, uint8_t instance, const void *data,
+		   size_t size);
+
+#endif
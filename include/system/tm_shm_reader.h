@@ -0,0 +1,65 @@
+#ifndef TM_SHM_READER_H_
+#define TM_SHM_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/tm_shm.h>
+
+/*
+ * Reader side of the telemetry shared memory segment, built as the
+ * obdh2-tm-shm static library for other processes. After
+ * tm_shm_reader_open(), reads are plain memory copies.
+ */
+
+/* Attempts of a read before giving up on a record being written */
+#define TM_SHM_READ_TRIES 1000U
+
+struct tm_shm_reader {
+	const struct tm_shm_hdr *hdr;
+	size_t size; /**< Of the mapping. */
+};
+
+/**
+ * \brief Maps the segment read-only.
+ *
+ * \param[out] reader is the reader.
+ *
+ * \param[in] name is the name of the segment, e.g. TM_SHM_NAME.
+ *
+ * \return 0 on success, -1 if the segment is missing or unsupported.
+ */
+int tm_shm_reader_open(struct tm_shm_reader *reader, const char *name);
+
+/**
+ * \brief Copies a consistent snapshot of the latest telemetry of a device.
+ *
+ * \param[in] reader is the reader.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] instance is the device index, e.g. the TTC radio.
+ *
+ * \param[out] data is a buffer to store the telemetry structure.
+ *
+ * \param[in] size is the size of the buffer.
+ *
+ * \param[out] timestamp is the time of the sample in microseconds, may be
+ * NULL.
+ *
+ * \return The size of the telemetry, 0 if there is no sample yet, or -1 if
+ * there is no such device, the buffer is too small or the record kept
+ * changing for TM_SHM_READ_TRIES attempts.
+ */
+long tm_shm_read(const struct tm_shm_reader *reader, enum tm_pub_type type,
+		 uint8_t instance, void *data, size_t size,
+		 uint64_t *timestamp);
+
+/**
+ * \brief Unmaps the segment.
+ *
+ * \param[in,out] reader is the reader.
+ */
+void tm_shm_reader_close(struct tm_shm_reader *reader);
+
+#endif
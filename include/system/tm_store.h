@@ -0,0 +1,112 @@
+#ifndef TM_STORE_H_
+#define TM_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/tm_pub.h>
+
+/*
+ * In-memory time series of the telemetry samples: the EPS data, the HK data
+ * of each TTC radio and the EDC HK. Each series keeps its last
+ * TM_STORE_CAPACITY samples as one ring buffer per field of the telemetry
+ * structure, plus one for the timestamps, so a query over a field only
+ * touches that field's values. Samples are timestamped when appended, in
+ * microseconds of the realtime clock, like the tm_pub_hdr timestamps. The
+ * timestamps of a series never decrease: if the clock is set back, the
+ * samples keep the last timestamp until the clock catches up.
+ */
+
+/* Samples kept per series, a power of two */
+#define TM_STORE_CAPACITY 1024U
+
+struct tm_store_agg {
+	size_t count; /**< Samples in the window, the rest is 0 if none. */
+	int64_t min;
+	int64_t max;
+	double mean;
+};
+
+/**
+ * \brief Appends a telemetry sample to its series.
+ *
+ * \param[in] type is the type of the telemetry: TM_PUB_EPS_DATA,
+ * TM_PUB_TTC_DATA or TM_PUB_EDC_HK.
+ *
+ * \param[in] instance is the device index, e.g. the TTC radio.
+ *
+ * \param[in] data is the telemetry structure.
+ *
+ * \param[in] size is the size of data, which must match the type.
+ *
+ * \return 0 on success, -1 if there is no such series.
+ */
+int tm_store_append(enum tm_pub_type type, uint8_t instance, const void *data,
+		    size_t size);
+
+/**
+ * \brief Gets the index of a field of a series.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] name is the name of the field, the same as the member of the
+ * telemetry structure, e.g. "battery_voltage".
+ *
+ * \return The index of the field, -1 if there is no such field.
+ */
+int tm_store_field(enum tm_pub_type type, const char *name);
+
+/**
+ * \brief Copies the samples of a field in a time window, oldest first.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] instance is the device index.
+ *
+ * \param[in] field is the index of the field, from tm_store_field().
+ *
+ * \param[in] from is the start of the window, in microseconds, included.
+ *
+ * \param[in] to is the end of the window, in microseconds, included.
+ *
+ * \param[in] from_number is the number of the first sample to copy, to page
+ * through a window: samples sharing a timestamp can't be told apart by it.
+ *
+ * \param[out] number is an array to store the sample numbers, which increase
+ * by one per sample appended to the series, may be NULL.
+ *
+ * \param[out] timestamp is an array to store the timestamps, may be NULL.
+ *
+ * \param[out] val is an array to store the values.
+ *
+ * \param[in] max is the size of the arrays.
+ *
+ * \return The number of samples copied, at most max, or -1 on invalid
+ * arguments.
+ */
+long tm_store_scan(enum tm_pub_type type, uint8_t instance, int field,
+		   uint64_t from, uint64_t to, uint64_t from_number,
+		   uint64_t *number, uint64_t *timestamp, int64_t *val,
+		   size_t max);
+
+/**
+ * \brief Computes the minimum, maximum and mean of a field in a time window.
+ *
+ * \param[in] type is the type of the telemetry.
+ *
+ * \param[in] instance is the device index.
+ *
+ * \param[in] field is the index of the field, from tm_store_field().
+ *
+ * \param[in] from is the start of the window, in microseconds, included.
+ *
+ * \param[in] to is the end of the window, in microseconds, included.
+ *
+ * \param[out] agg is the aggregate.
+ *
+ * \return 0 on success, -1 on invalid arguments.
+ */
+int tm_store_aggregate(enum tm_pub_type type, uint8_t instance, int field,
+		       uint64_t from, uint64_t to, struct tm_store_agg *agg);
+
+#endif
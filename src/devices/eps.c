@@ -33,8 +33,13 @@
  * \{
  */
 
+#include <pthread.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
 
+#include <system/blackboard.h>
+#include <system/dev_health.h>
 #include <system/sys_log.h>
 #include <drivers/sl_eps2.h>
 #include <devices/eps.h>
@@ -43,39 +48,240 @@ static sl_eps2_config_t eps_config = { 0 };
 
 static bool eps_is_open = false;
 
+static void eps_publish_health(enum dev_health_state state)
+{
+	blackboard_set_health(BLACKBOARD_DEV_EPS, state);
+}
+
+static struct dev_health eps_health = DEV_HEALTH_INIT(EPS_MODULE_NAME,
+							 eps_publish_health);
+
+/*
+ * Shadow of the EPS registers: the last value written to or read from each
+ * one, served instead of a new transfer while younger than the TTL of the
+ * register. Guarded by the EPS lock.
+ */
+struct eps_shadow {
+	uint32_t val;
+	uint64_t stamp_ms;
+	bool valid;
+};
+
+static struct eps_shadow eps_shadow[SL_EPS2_REG_COUNT];
+
+static uint16_t eps_shadow_reset_counter;
+
+static bool eps_shadow_reset_known = false;
+
+static pthread_mutex_t eps_mutex;
+
+static pthread_once_t eps_mutex_once = PTHREAD_ONCE_INIT;
+
+static void eps_mutex_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&eps_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+void eps_lock(void)
+{
+	pthread_once(&eps_mutex_once, eps_mutex_init);
+	pthread_mutex_lock(&eps_mutex);
+}
+
+void eps_unlock(void)
+{
+	pthread_mutex_unlock(&eps_mutex);
+}
+
+static uint64_t eps_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000U) +
+	       ((uint64_t)ts.tv_nsec / 1000000U);
+}
+
+static uint32_t eps_shadow_ttl_ms(eps_param_id_t param)
+{
+	switch (param) {
+	case SL_EPS2_REG_DEVICE_ID:
+	case SL_EPS2_REG_HARDWARE_VERSION:
+	case SL_EPS2_REG_FIRMWARE_VERSION:
+		return EPS_SHADOW_TTL_STATIC_MS;
+	case SL_EPS2_REG_RESET_EPS:
+		return 0U; /* A command, every write counts */
+	default:
+		break;
+	}
+
+	return (sl_eps2_get_reg_class(param) == SL_EPS2_REG_CLASS_CONFIG) ?
+		       EPS_SHADOW_TTL_CONFIG_MS :
+		       EPS_SHADOW_TTL_MEASUREMENT_MS;
+}
+
+static bool eps_shadow_get(eps_param_id_t param, uint32_t *val)
+{
+	if ((param >= SL_EPS2_REG_COUNT) || !eps_shadow[param].valid)
+		return false;
+
+	uint32_t ttl = eps_shadow_ttl_ms(param);
+
+	if ((ttl != EPS_SHADOW_TTL_STATIC_MS) &&
+	    ((eps_now_ms() - eps_shadow[param].stamp_ms) >= ttl))
+		return false;
+
+	*val = eps_shadow[param].val;
+
+	return true;
+}
+
+static void eps_shadow_set(eps_param_id_t param, uint32_t val)
+{
+	if ((param >= SL_EPS2_REG_COUNT) || (eps_shadow_ttl_ms(param) == 0U))
+		return;
+
+	eps_shadow[param].val = val;
+	eps_shadow[param].stamp_ms = eps_now_ms();
+	eps_shadow[param].valid = true;
+}
+
+static void eps_shadow_drop(eps_param_id_t param)
+{
+	if (param < SL_EPS2_REG_COUNT)
+		eps_shadow[param].valid = false;
+}
+
+/* A reset brings every register back to its default */
+static void eps_shadow_drop_all(void)
+{
+	(void)memset(eps_shadow, 0, sizeof(eps_shadow));
+}
+
+/* Keeps the shadow in step with a full read of the EPS */
+static void eps_shadow_update(const eps_data_t *data)
+{
+	if (eps_shadow_reset_known &&
+	    (data->reset_counter != eps_shadow_reset_counter)) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, EPS_MODULE_NAME,
+			"EPS reset detected, dropping the register shadow");
+
+		eps_shadow_drop_all();
+	}
+
+	eps_shadow_reset_counter = data->reset_counter;
+	eps_shadow_reset_known = true;
+
+	eps_shadow_set(SL_EPS2_REG_MPPT_1_MODE, data->mppt_1_mode);
+	eps_shadow_set(SL_EPS2_REG_MPPT_2_MODE, data->mppt_2_mode);
+	eps_shadow_set(SL_EPS2_REG_MPPT_3_MODE, data->mppt_3_mode);
+	eps_shadow_set(SL_EPS2_REG_BAT_HEATER_1_MODE,
+		       data->battery_heater_1_mode);
+	eps_shadow_set(SL_EPS2_REG_BAT_HEATER_2_MODE,
+		       data->battery_heater_2_mode);
+	eps_shadow_set(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
+		       data->battery_heater_1_duty_cycle);
+	eps_shadow_set(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
+		       data->battery_heater_2_duty_cycle);
+}
+
 int eps_init(void)
 {
 	int err = -1;
 
-	if (eps_is_open) {
-		err = 0; /* EPS device already initialized */
-	} else {
-		int err_drv = sl_eps2_init(eps_config);
-
-		if (err_drv == 0) {
+	eps_lock();
+
+	/* A ready device is not initialized again, an offline one is left alone */
+	switch (dev_health_begin(&eps_health)) {
+	case DEV_HEALTH_USE:
+		err = 0;
+		break;
+	case DEV_HEALTH_SKIP:
+		break;
+	default:
+		if (sl_eps2_init(eps_config) == 0) {
 			eps_is_open = true;
 
+			/* Checked by the driver, no need to read it again */
+			eps_shadow_set(SL_EPS2_REG_DEVICE_ID, SL_EPS2_DEVICE_ID);
+
 			err = 0;
 		}
+
+		dev_health_report(&eps_health, err == 0);
+		break;
 	}
 
+	eps_unlock();
+
 	return err;
 }
 
 int eps_set_param(eps_param_id_t param, uint32_t val)
 {
-	return sl_eps2_write_reg(eps_config, param, val);
+	int err = 0;
+	uint32_t cur = 0U;
+
+	eps_lock();
+
+	/* Skipped when offline, or when the register already holds the value */
+	if (dev_health_begin(&eps_health) == DEV_HEALTH_SKIP) {
+		err = -1;
+	} else if (!eps_shadow_get(param, &cur) || (cur != val)) {
+		err = sl_eps2_write_reg(eps_config, param, val);
+
+		dev_health_report(&eps_health, err == 0);
+
+		if (param == SL_EPS2_REG_RESET_EPS)
+			eps_shadow_drop_all();
+		else if (err == 0)
+			eps_shadow_set(param, val);
+		else
+			eps_shadow_drop(param);
+	}
+
+	eps_unlock();
+
+	return err;
 }
 
 int eps_get_param(eps_param_id_t param, uint32_t *val)
 {
-	return sl_eps2_read_reg(eps_config, param, val);
+	int err = 0;
+
+	eps_lock();
+
+	if (eps_shadow_get(param, val)) {
+		/* Served from the shadow */
+	} else if (dev_health_begin(&eps_health) == DEV_HEALTH_SKIP) {
+		err = -1;
+	} else {
+		err = sl_eps2_read_reg(eps_config, param, val);
+
+		dev_health_report(&eps_health, err == 0);
+
+		if (err == 0)
+			eps_shadow_set(param, *val);
+	}
+
+	eps_unlock();
+
+	return err;
 }
 
 int eps_get_bat_voltage(eps_voltage_t *bat_volt)
 {
 	int err = -1;
 
+	eps_lock();
+
 	if (eps_is_open) {
 		int err_drv =
 			sl_eps2_read_battery_voltage(eps_config, bat_volt);
@@ -85,6 +291,8 @@ int eps_get_bat_voltage(eps_voltage_t *bat_volt)
 		}
 	}
 
+	eps_unlock();
+
 	return err;
 }
 
@@ -92,6 +300,8 @@ int eps_get_bat_current(eps_current_t *bat_cur)
 {
 	int err = -1;
 
+	eps_lock();
+
 	if (eps_is_open) {
 		int err_drv = sl_eps2_read_battery_current(
 			eps_config, SL_EPS2_BATTERY_CURRENT, bat_cur);
@@ -101,6 +311,8 @@ int eps_get_bat_current(eps_current_t *bat_cur)
 		}
 	}
 
+	eps_unlock();
+
 	return err;
 }
 
@@ -108,6 +320,8 @@ int eps_get_bat_charge(eps_charge_t *charge)
 {
 	int err = -1;
 
+	eps_lock();
+
 	if (eps_is_open) {
 		int err_drv = sl_eps2_read_battery_charge(eps_config, charge);
 
@@ -116,6 +330,8 @@ int eps_get_bat_charge(eps_charge_t *charge)
 		}
 	}
 
+	eps_unlock();
+
 	return err;
 }
 
@@ -123,14 +339,23 @@ int eps_get_data(eps_data_t *data)
 {
 	int err = -1;
 
-	if (eps_is_open) {
+	eps_lock();
+
+	if (eps_is_open &&
+	    (dev_health_begin(&eps_health) != DEV_HEALTH_SKIP)) {
 		int err_drv = sl_eps2_read_data(eps_config, data);
 
 		if (err_drv == 0) {
+			eps_shadow_update(data);
+
 			err = 0;
 		}
+
+		dev_health_report(&eps_health, err == 0);
 	}
 
+	eps_unlock();
+
 	return err;
 }
 
@@ -242,7 +467,7 @@ void eps_print_data(const eps_data_t *data)
 
 	tmp = (int16_t)data->battery_average_current;
 	sys_log_print_event_from_module(SYS_LOG_INFO, EPS_MODULE_NAME,
-					"Battery average current: %i mA");
+					"Battery average current: %i mA", tmp);
 
 	sys_log_print_event_from_module(SYS_LOG_INFO, EPS_MODULE_NAME,
 					"Battery accumalated current: %u mAh", (uint32_t)data->battery_acc_current);
@@ -254,10 +479,10 @@ void eps_print_data(const eps_data_t *data)
 					"Heater 2 Mode: %u", (uint32_t)data->battery_heater_2_mode);
 
 	sys_log_print_event_from_module(SYS_LOG_INFO, EPS_MODULE_NAME,
-					"Heater 1 Duty Cycle: %u %", (uint32_t)data->battery_heater_1_duty_cycle);
+					"Heater 1 Duty Cycle: %u %%", (uint32_t)data->battery_heater_1_duty_cycle);
 
 	sys_log_print_event_from_module(SYS_LOG_INFO, EPS_MODULE_NAME,
-					"Heater 2 Duty Cycle: %u %", (uint32_t)data->battery_heater_2_duty_cycle);
+					"Heater 2 Duty Cycle: %u %%", (uint32_t)data->battery_heater_2_duty_cycle);
 }
 
 /** \} End of eps group */
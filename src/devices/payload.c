@@ -4,13 +4,45 @@
 #include <devices/payload.h>
 #include <drivers/edc.h>
 
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 
 #define PAYLOAD_UNIX_TO_J2000_EPOCH(x) ((x) - 946684800)
 
-static int edc_pl_init(struct payload *pl)
+static pthread_mutex_t edc_mutex;
+
+/* Last PTT packet popped, answered again until the next one is decoded */
+static edc_ptt_t edc_last_ptt;
+
+static bool edc_last_ptt_valid;
+
+static pthread_once_t edc_mutex_once = PTHREAD_ONCE_INIT;
+
+static void edc_mutex_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&edc_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+void payload_edc_lock(void)
+{
+	pthread_once(&edc_mutex_once, edc_mutex_init);
+	pthread_mutex_lock(&edc_mutex);
+}
+
+void payload_edc_unlock(void)
+{
+	pthread_mutex_unlock(&edc_mutex);
+}
+
+static int edc_pl_init_locked(struct payload *pl)
 {
 	int err = PL_OK;
 
@@ -32,14 +64,25 @@ static int edc_pl_init(struct payload *pl)
 	return err;
 }
 
+static int edc_pl_init(struct payload *pl)
+{
+	payload_edc_lock();
+
+	int err = edc_pl_init_locked(pl);
+
+	payload_edc_unlock();
+
+	return err;
+}
+
 static int edc_pl_write_data(struct payload *pl, const uint8_t type,
 			     uint8_t *data, uint16_t size)
 {
 	return -PL_ERRNO_UNSUPPORTED_FN;
 }
 
-static int edc_pl_read_data(struct payload *pl, const uint8_t type,
-			    uint8_t *data, uint16_t size)
+static int edc_pl_read_data_locked(struct payload *pl, const uint8_t type,
+				   uint8_t *data, uint16_t size)
 {
 	int err = -PL_ERRNO_UNKNOWN;
 
@@ -81,12 +124,23 @@ static int edc_pl_read_data(struct payload *pl, const uint8_t type,
 			return -PL_ERRNO_DATA;
 
 		if (edc_get_ptt(conf, &ptt) == 0) {
+			/* Popping it would drop the next packet, unread */
+			if (edc_last_ptt_valid &&
+			    (ptt.time_tag == edc_last_ptt.time_tag) &&
+			    (ptt.carrier_freq == edc_last_ptt.carrier_freq)) {
+				err = -PL_ERRNO_TIMEOUT;
+				break;
+			}
+
 			for (uint8_t i = 0U; i < sizeof(ptt); ++i) {
 				data[i] = ((uint8_t *)&ptt)[i];
 			}
 
-			if (edc_pop_ptt_pkg(conf) == 0)
+			if (edc_pop_ptt_pkg(conf) == 0) {
+				edc_last_ptt = ptt;
+				edc_last_ptt_valid = true;
 				err = PL_OK;
+			}
 		}
 		break;
 	}
@@ -97,8 +151,21 @@ static int edc_pl_read_data(struct payload *pl, const uint8_t type,
 
 	return err;
 }
-static int edc_pl_write_cmd(struct payload *pl, const uint8_t cmd,
-			    uint8_t *cmd_args, uint16_t args_size)
+
+static int edc_pl_read_data(struct payload *pl, const uint8_t type,
+			    uint8_t *data, uint16_t size)
+{
+	payload_edc_lock();
+
+	int err = edc_pl_read_data_locked(pl, type, data, size);
+
+	payload_edc_unlock();
+
+	return err;
+}
+
+static int edc_pl_write_cmd_locked(struct payload *pl, const uint8_t cmd,
+				   uint8_t *cmd_args, uint16_t args_size)
 {
 	edc_config_t *conf = pl->payload_data;
 	edc_cmd_t c = { 0 };
@@ -116,8 +183,20 @@ static int edc_pl_write_cmd(struct payload *pl, const uint8_t cmd,
 	return PL_OK;
 }
 
-static int edc_pl_set_clock(struct payload *pl,
-			    const struct payload_timestamp *ts)
+static int edc_pl_write_cmd(struct payload *pl, const uint8_t cmd,
+			    uint8_t *cmd_args, uint16_t args_size)
+{
+	payload_edc_lock();
+
+	int err = edc_pl_write_cmd_locked(pl, cmd, cmd_args, args_size);
+
+	payload_edc_unlock();
+
+	return err;
+}
+
+static int edc_pl_set_clock_locked(struct payload *pl,
+				   const struct payload_timestamp *ts)
 {
 	edc_config_t *conf = pl->payload_data;
 
@@ -128,6 +207,18 @@ static int edc_pl_set_clock(struct payload *pl,
 	return PL_OK;
 }
 
+static int edc_pl_set_clock(struct payload *pl,
+			    const struct payload_timestamp *ts)
+{
+	payload_edc_lock();
+
+	int err = edc_pl_set_clock_locked(pl, ts);
+
+	payload_edc_unlock();
+
+	return err;
+}
+
 static int edc_pl_get_clock(struct payload *pl, struct payload_timestamp *ts)
 {
 	return -PL_ERRNO_UNSUPPORTED_FN;
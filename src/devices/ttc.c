@@ -36,45 +36,77 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include <system/blackboard.h>
+#include <system/dev_health.h>
 #include <system/sys_log.h>
 #include <devices/ttc.h>
 
 static ttc_config_t ttc_0_config;
 static ttc_config_t ttc_1_config;
 
-int ttc_init(ttc_e dev)
+static void ttc_0_publish_health(enum dev_health_state state)
+{
+	blackboard_set_health(BLACKBOARD_DEV_TTC_0, state);
+}
+
+static void ttc_1_publish_health(enum dev_health_state state)
+{
+	blackboard_set_health(BLACKBOARD_DEV_TTC_1, state);
+}
+
+static struct dev_health ttc_health[TTC_COUNT] = {
+	[TTC_0] = DEV_HEALTH_INIT("TTC0", ttc_0_publish_health),
+	[TTC_1] = DEV_HEALTH_INIT("TTC1", ttc_1_publish_health),
+};
+
+/*
+ * Checks the device ID when the health of the device asks for a probe.
+ * Returns 0 when the device can be used.
+ */
+static int ttc_ready(ttc_e dev, ttc_config_t *config)
 {
-	static bool ttc_0_is_open = false;
-	static bool ttc_1_is_open = false;
+	switch (dev_health_begin(&ttc_health[dev])) {
+	case DEV_HEALTH_USE:
+		return 0;
+	case DEV_HEALTH_SKIP:
+		return -1;
+	default:
+		break;
+	}
+
+	int err = sl_ttc2_check_device(config);
+
+	dev_health_report(&ttc_health[dev], err == 0);
+
+	return err;
+}
 
+int ttc_init(ttc_e dev)
+{
 	int err = -2;
 
 	ttc_config_t ttc_config = { 0 };
 
 	switch (dev) {
 	case TTC_0:
-		if (ttc_0_is_open) {
-			err = 0; /* TTC 0 device already initialized */
-		} else {
+		if (ttc_0_config.port_config[0] == '\0') {
 			strncpy(ttc_0_config.port_config, "/dev/spidev2.0",
 				sizeof(ttc_0_config.port_config));
 			ttc_0_config.id = SL_TTC2_RADIO_0;
-
-			ttc_config = ttc_0_config;
 		}
 
+		ttc_config = ttc_0_config;
+
 		break;
 	case TTC_1:
-		if (ttc_1_is_open) {
-			err = 0; /* TTC 1 device already initialized */
-		} else {
+		if (ttc_1_config.port_config[0] == '\0') {
 			strncpy(ttc_1_config.port_config, "/dev/spidev2.1",
 				sizeof(ttc_1_config.port_config));
 			ttc_1_config.id = SL_TTC2_RADIO_1;
-
-			ttc_config = ttc_1_config;
 		}
 
+		ttc_config = ttc_1_config;
+
 		break;
 	default:
 		sys_log_print_event_from_module(
@@ -86,6 +118,20 @@ int ttc_init(ttc_e dev)
 		break;
 	}
 
+	/* A ready device is not initialized again, an offline one is left alone */
+	if (err == -2) {
+		switch (dev_health_begin(&ttc_health[dev])) {
+		case DEV_HEALTH_USE:
+			err = 0;
+			break;
+		case DEV_HEALTH_SKIP:
+			err = -1;
+			break;
+		default:
+			break;
+		}
+	}
+
 	if (err == -2) {
 		sys_log_print_event_from_module(SYS_LOG_INFO, TTC_MODULE_NAME,
 						"Initializing TTC device %u...",
@@ -105,17 +151,6 @@ int ttc_init(ttc_e dev)
 						"SpaceLab TTC 2.0 detected! (hw=%u, fw=%u)",
 						hw_ver, fw_ver);
 
-					switch (dev) {
-					case TTC_0:
-						ttc_0_is_open = true;
-						break;
-					case TTC_1:
-						ttc_1_is_open = true;
-						break;
-					default:
-						break;
-					}
-
 					err = 0;
 				} else {
 					sys_log_print_event_from_module(
@@ -141,6 +176,8 @@ int ttc_init(ttc_e dev)
 
 			err = -1;
 		}
+
+		dev_health_report(&ttc_health[dev], err == 0);
 	}
 
 	return err;
@@ -213,7 +250,7 @@ int ttc_get_data(ttc_e dev, ttc_data_t *data)
 	}
 
 	if (err == 0) {
-		if (sl_ttc2_check_device(&ttc_config) == 0) {
+		if (ttc_ready(dev, &ttc_config) == 0) {
 			if (sl_ttc2_read_hk_data(&ttc_config, data) != 0) {
 				sys_log_print_event_from_module(
 					SYS_LOG_ERROR, TTC_MODULE_NAME,
@@ -222,17 +259,78 @@ int ttc_get_data(ttc_e dev, ttc_data_t *data)
 
 				err = -1;
 			}
+
+			dev_health_report(&ttc_health[dev], err == 0);
 		} else {
 			sys_log_print_event_from_module(
 				SYS_LOG_ERROR, TTC_MODULE_NAME,
 				"Failed to check the TTC device %u!",
 				ttc_config.id);
+
+			err = -1;
 		}
 	}
 
 	return err;
 }
 
+int ttc_get_data_all(ttc_data_t *data, int *err)
+{
+	ttc_config_t *configs[TTC_COUNT] = { &ttc_0_config, &ttc_1_config };
+	ttc_config_t *checked[TTC_COUNT];
+	ttc_data_t checked_data[TTC_COUNT];
+	int failed[TTC_COUNT] = { 0 };
+	uint8_t n = 0U;
+	int res = 0;
+
+	/* Only the devices that can be used are read */
+	for (unsigned int i = 0U; i < TTC_COUNT; i++) {
+		err[i] = ttc_ready((ttc_e)i, configs[i]);
+
+		if (err[i] == 0) {
+			checked[n++] = configs[i];
+		} else {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, TTC_MODULE_NAME,
+				"Failed to check the TTC device %u!",
+				configs[i]->id);
+		}
+	}
+
+	if ((n > 0U) &&
+	    (sl_ttc2_read_hk_data_multi(checked, checked_data, failed, n) !=
+	     0)) {
+		for (uint8_t j = 0U; j < n; j++) {
+			failed[j] = -1;
+		}
+	}
+
+	for (uint8_t j = 0U; j < n; j++) {
+		ttc_e i = (checked[j] == &ttc_0_config) ? TTC_0 : TTC_1;
+
+		dev_health_report(&ttc_health[i], failed[j] == 0);
+
+		if (failed[j] != 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, TTC_MODULE_NAME,
+				"Error reading the data from the TTC device %u!",
+				checked[j]->id);
+
+			err[i] = -1;
+		} else {
+			data[i] = checked_data[j];
+		}
+	}
+
+	for (unsigned int i = 0U; i < TTC_COUNT; i++) {
+		if (err[i] != 0) {
+			res = -1;
+		}
+	}
+
+	return res;
+}
+
 int ttc_send(ttc_e dev, uint8_t *data, uint16_t len)
 {
 	int err = -1;
@@ -257,7 +355,7 @@ int ttc_send(ttc_e dev, uint8_t *data, uint16_t len)
 	}
 
 	if (err == 0) {
-		if (sl_ttc2_check_device(&ttc_config) == 0) {
+		if (ttc_ready(dev, &ttc_config) == 0) {
 			if (sl_ttc2_transmit_packet(&ttc_config, data, len) !=
 			    0) {
 				sys_log_print_event_from_module(
@@ -267,6 +365,8 @@ int ttc_send(ttc_e dev, uint8_t *data, uint16_t len)
 
 				err = -1;
 			}
+
+			dev_health_report(&ttc_health[dev], err == 0);
 		} else {
 			sys_log_print_event_from_module(
 				SYS_LOG_ERROR, TTC_MODULE_NAME,
@@ -435,6 +535,18 @@ int ttc_check_failed_pkts(ttc_e dev)
 	return err;
 }
 
+void ttc_lock(void)
+{
+	(void)sl_ttc2_radio_mutex_take(SL_TTC2_RADIO_0);
+	(void)sl_ttc2_radio_mutex_take(SL_TTC2_RADIO_1);
+}
+
+void ttc_unlock(void)
+{
+	(void)sl_ttc2_radio_mutex_give(SL_TTC2_RADIO_1);
+	(void)sl_ttc2_radio_mutex_give(SL_TTC2_RADIO_0);
+}
+
 void ttc_print_data(const ttc_e dev, const ttc_data_t *data)
 {
 	const char *dev_str[] = { "TTC0", "TTC1" };
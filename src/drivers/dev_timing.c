@@ -0,0 +1,277 @@
+/*
+ * dev_timing.c
+ *
+ * Copyright The OBDH 2.0 Contributors
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief Adaptive device response timing implementation.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \addtogroup dev_timing
+ * \{
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <drivers/dev_timing.h>
+
+/* Weight of a new sample in the learnt latency, as a power of two */
+#define DEV_TIMING_EWMA_SHIFT 3U
+
+struct dev_timing_saved {
+	char name[DEV_TIMING_NAME_MAX];
+	uint32_t latency_us;
+};
+
+static struct dev_timing_saved saved[DEV_TIMING_MAX];
+
+static unsigned int saved_len;
+
+static struct dev_timing *timings;
+
+/* Guards the saved values and the list of timings, none is on a hot path */
+static pthread_mutex_t timings_lock = PTHREAD_MUTEX_INITIALIZER;
+
+uint64_t dev_timing_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000U) +
+	       ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+static void dev_timing_sleep_until(uint64_t us)
+{
+	struct timespec ts = {
+		.tv_sec = (time_t)(us / 1000000U),
+		.tv_nsec = (long)((us % 1000000U) * 1000U),
+	};
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+	       EINTR) {
+	}
+}
+
+/* Adds a timing to the list saved by dev_timing_save() on its first use */
+static void dev_timing_register(struct dev_timing *timing)
+{
+	if (atomic_load_explicit(&timing->registered, memory_order_acquire))
+		return;
+
+	pthread_mutex_lock(&timings_lock);
+
+	if (!atomic_load_explicit(&timing->registered, memory_order_relaxed)) {
+		for (unsigned int i = 0U; i < saved_len; ++i) {
+			if (strcmp(saved[i].name, timing->name) == 0) {
+				atomic_store_explicit(&timing->latency_us,
+						      saved[i].latency_us,
+						      memory_order_relaxed);
+				break;
+			}
+		}
+
+		timing->next = timings;
+		timings = timing;
+
+		atomic_store_explicit(&timing->registered, true,
+				      memory_order_release);
+	}
+
+	pthread_mutex_unlock(&timings_lock);
+}
+
+void dev_timing_record(struct dev_timing *timing, uint32_t us)
+{
+	uint32_t lat = atomic_load_explicit(&timing->latency_us,
+					    memory_order_relaxed);
+
+	if (lat == 0U) {
+		lat = (us > 0U) ? us : 1U;
+	} else {
+		int64_t diff = (int64_t)us - (int64_t)lat;
+
+		lat = (uint32_t)((int64_t)lat +
+				 (diff / (1 << DEV_TIMING_EWMA_SHIFT)));
+
+		if (lat == 0U)
+			lat = 1U;
+	}
+
+	atomic_store_explicit(&timing->latency_us, lat, memory_order_relaxed);
+}
+
+int dev_timing_wait(struct dev_timing *timing, dev_timing_poll_t poll,
+		    void *arg)
+{
+	return dev_timing_wait_from(timing, dev_timing_now_us(), poll, arg);
+}
+
+int dev_timing_wait_from(struct dev_timing *timing, uint64_t start,
+			 dev_timing_poll_t poll, void *arg)
+{
+	dev_timing_register(timing);
+
+	uint32_t lat = atomic_load_explicit(&timing->latency_us,
+					    memory_order_relaxed);
+
+	/*
+	 * Polling a bit early lets the learnt latency follow a device that
+	 * got faster, the backoff bounds the cost of being early.
+	 */
+	uint32_t at = lat - (lat >> DEV_TIMING_EWMA_SHIFT);
+	uint32_t backoff = DEV_TIMING_BACKOFF_MIN_US;
+	uint32_t backoff_max = DEV_TIMING_BACKOFF_MAX_US;
+
+	/* Each poll is a request too, for a device with a minimum gap */
+	if (timing->backoff_min_us > backoff)
+		backoff = timing->backoff_min_us;
+
+	if (backoff > backoff_max)
+		backoff_max = backoff;
+
+	uint32_t gap = backoff;
+
+	if (at < timing->floor_us)
+		at = timing->floor_us;
+
+	if (at > timing->limit_us)
+		at = timing->limit_us;
+
+	for (;;) {
+		dev_timing_sleep_until(start + at);
+
+		uint64_t polled = dev_timing_now_us();
+		int ret = poll(arg);
+
+		if (ret == 0) {
+			dev_timing_record(timing, (uint32_t)(polled - start));
+			return 0;
+		}
+
+		if ((ret != DEV_TIMING_NOT_READY) && (ret != DEV_TIMING_STALE))
+			return -1;
+
+		uint32_t elapsed = (uint32_t)(polled - start);
+
+		/* No other response came, a stale one may be the right one */
+		if ((at >= timing->limit_us) ||
+		    (elapsed + gap > timing->limit_us))
+			return (ret == DEV_TIMING_STALE) ? 0 : -1;
+
+		at = elapsed + backoff;
+
+		if (at > timing->limit_us)
+			at = timing->limit_us;
+
+		backoff *= 2U;
+
+		if (backoff > backoff_max)
+			backoff = backoff_max;
+	}
+}
+
+int dev_timing_load(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char name[DEV_TIMING_NAME_MAX];
+	unsigned long us = 0UL;
+
+	if (f == NULL)
+		return -1;
+
+	pthread_mutex_lock(&timings_lock);
+
+	while ((saved_len < DEV_TIMING_MAX) &&
+	       (fscanf(f, "%23s %lu", name, &us) == 2)) {
+		if ((us == 0UL) || (us > UINT32_MAX))
+			continue;
+
+		strcpy(saved[saved_len].name, name);
+		saved[saved_len].latency_us = (uint32_t)us;
+
+		/* Timings already in use take the saved value at once */
+		for (struct dev_timing *t = timings; t != NULL; t = t->next) {
+			if (strcmp(t->name, name) == 0) {
+				atomic_store_explicit(&t->latency_us,
+						      (uint32_t)us,
+						      memory_order_relaxed);
+			}
+		}
+
+		saved_len++;
+	}
+
+	pthread_mutex_unlock(&timings_lock);
+
+	fclose(f);
+
+	return 0;
+}
+
+int dev_timing_save(const char *path)
+{
+	char tmp[PATH_MAX];
+	int err = 0;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+		return -1;
+
+	FILE *f = fopen(tmp, "w");
+
+	if (f == NULL)
+		return -1;
+
+	pthread_mutex_lock(&timings_lock);
+
+	for (struct dev_timing *t = timings; t != NULL; t = t->next) {
+		uint32_t lat = atomic_load_explicit(&t->latency_us,
+						    memory_order_relaxed);
+
+		if (lat > 0U)
+			fprintf(f, "%s %lu\n", t->name, (unsigned long)lat);
+	}
+
+	pthread_mutex_unlock(&timings_lock);
+
+	if (fclose(f) != 0)
+		err = -1;
+
+	if ((err == 0) && (rename(tmp, path) != 0))
+		err = -1;
+
+	if (err != 0)
+		(void)remove(tmp);
+
+	return err;
+}
+
+/** \} End of dev_timing group */
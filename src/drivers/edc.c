@@ -37,7 +37,119 @@
 #include <math.h>
 #include <string.h>
 
+#include <drivers/dev_timing.h>
 #include <drivers/edc.h>
+#include <system/checksum.h>
+
+/* The 10 ms minimum gap between I2C commands is the earliest poll and retry */
+static struct dev_timing edc_timing = DEV_TIMING_INIT_GAP("edc", 10000U, 200000U, 10000U);
+
+/**
+ * \brief Last frame read of an ID, to tell a new answer from a stale one.
+ */
+struct edc_last_frame
+{
+    uint8_t id;
+    uint16_t len;               /**< 0 before the first frame. */
+    uint8_t frame[EDC_FRAME_PTT_LEN];
+};
+
+static struct edc_last_frame edc_last_frames[] =
+{
+    {.id = EDC_FRAME_ID_STATE},
+    {.id = EDC_FRAME_ID_PTT},
+    {.id = EDC_FRAME_ID_HK},
+};
+
+struct edc_poll
+{
+    edc_config_t *config;
+    uint8_t id;
+    uint8_t *frame;
+    uint16_t len;
+    struct edc_last_frame *last;
+};
+
+static struct edc_last_frame *edc_get_last_frame(uint8_t id, uint16_t len)
+{
+    size_t i = 0U;
+    for (i = 0U; i < (sizeof(edc_last_frames) / sizeof(edc_last_frames[0])); i++)
+    {
+        if ((edc_last_frames[i].id == id) && (len <= sizeof(edc_last_frames[i].frame)))
+        {
+            return &edc_last_frames[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int edc_poll_frame(void *arg)
+{
+    struct edc_poll *poll = (struct edc_poll *)arg;
+
+    if (edc_read(poll->config, poll->frame, poll->len) != 0)
+    {
+        return -1;
+    }
+
+    /* Until the frame is ready, the read returns stale or idle bytes */
+    if ((poll->frame[0] != poll->id) ||
+        (poll->frame[poll->len-1] != edc_calc_checksum(poll->frame, poll->len-1)))
+    {
+        return DEV_TIMING_NOT_READY;
+    }
+
+    /* The answer of the previous command with the same ID, or a new identical one */
+    if ((poll->last != NULL) && (poll->last->len == poll->len) &&
+        (memcmp(poll->last->frame, poll->frame, poll->len) == 0))
+    {
+        return DEV_TIMING_STALE;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Reads the answer frame of a command that was just written.
+ *
+ * Over I2C the frame is polled for until it has the expected ID, a valid
+ * checksum and differs from the last frame of that ID, which the EDC keeps
+ * in its output buffer until the answer is ready. A frame identical to the
+ * last one is only accepted once the limit is reached. A UART read consumes
+ * the answer, so it is read once after a fixed delay instead.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+static int edc_read_frame(edc_config_t *config, uint8_t id, uint8_t *frame, uint16_t len)
+{
+    if (config->interface == EDC_IF_I2C)
+    {
+        struct edc_poll poll = {config, id, frame, len, edc_get_last_frame(id, len)};
+
+        if (dev_timing_wait(&edc_timing, edc_poll_frame, &poll) != 0)
+        {
+            return -1;
+        }
+
+        if (poll.last != NULL)
+        {
+            memcpy(poll.last->frame, frame, len);
+            poll.last->len = len;
+        }
+
+        return 0;
+    }
+
+    edc_delay_ms(100);  /* 10 ms is not enough when using the UART interface! */
+
+    if (edc_read(config, frame, len) != 0)
+    {
+        return -1;
+    }
+
+    return (frame[0] == id) ? 0 : -1;
+}
 
 int edc_init(edc_config_t *config)
 {
@@ -228,15 +340,9 @@ int16_t edc_get_state_pkg(edc_config_t *config, uint8_t *status)
 
     if (edc_write_cmd(config, cmd) == 0)
     {
-        /* A minimum time gap of 10 ms must be forced between consecutive I2C commands */
-        edc_delay_ms(100);  /* 10 ms is not enough when using the UART interface! */
-
-        if (edc_read(config, status, EDC_FRAME_STATE_LEN) == 0)
+        if (edc_read_frame(config, EDC_FRAME_ID_STATE, status, EDC_FRAME_STATE_LEN) == 0)
         {
-            if (status[0] == EDC_FRAME_ID_STATE)
-            {
-                res = EDC_FRAME_STATE_LEN;
-            }
+            res = EDC_FRAME_STATE_LEN;
         }
     }
 
@@ -253,15 +359,9 @@ int16_t edc_get_ptt_pkg(edc_config_t *config, uint8_t *pkg)
 
     if (edc_write_cmd(config, cmd) == 0)
     {
-        /* A minimum time gap of 10 ms must be forced between consecutive I2C commands */
-        edc_delay_ms(100);  /* 10 ms is not enough when using the UART interface! */
-
-        if (edc_read(config, pkg, EDC_FRAME_PTT_LEN) == 0)
+        if (edc_read_frame(config, EDC_FRAME_ID_PTT, pkg, EDC_FRAME_PTT_LEN) == 0)
         {
-            if (pkg[0] == EDC_FRAME_ID_PTT)
-            {
-                res = EDC_FRAME_PTT_LEN;
-            }
+            res = EDC_FRAME_PTT_LEN;
         }
     }
 
@@ -278,15 +378,9 @@ int16_t edc_get_hk_pkg(edc_config_t *config, uint8_t *hk)
 
     if (edc_write_cmd(config, cmd) == 0)
     {
-        /* A minimum time gap of 10 ms must be forced between consecutive I2C commands */
-        edc_delay_ms(100);  /* 10 ms is not enough when using the UART interface! */
-
-        if (edc_read(config, hk, EDC_FRAME_HK_LEN) == 0)
+        if (edc_read_frame(config, EDC_FRAME_ID_HK, hk, EDC_FRAME_HK_LEN) == 0)
         {
-            if (hk[0] == EDC_FRAME_ID_HK)
-            {
-                res = EDC_FRAME_HK_LEN;
-            }
+            res = EDC_FRAME_HK_LEN;
         }
     }
 
@@ -356,14 +450,7 @@ int edc_echo(edc_config_t *config)
 
 uint16_t edc_calc_checksum(uint8_t *data, uint16_t len)
 {
-    uint16_t checksum = 0;
-
-    for(uint16_t i=0; i<len; i++)
-    {
-        checksum ^= data[i];
-    }
-
-    return checksum;
+    return checksum_xor8(data, len);
 }
 
 int edc_get_state(edc_config_t *config, edc_state_t *state_data)
@@ -0,0 +1,227 @@
+/*
+ * i2c_bus.c
+ *
+ * Copyright The OBDH 2.0 Contributors
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief Shared I2C adapter handles implementation.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \addtogroup i2c_bus
+ * \{
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <drivers/i2c_bus.h>
+
+struct i2c_bus {
+	char path[I2C_BUS_PATH_MAX];
+	int fd;
+	int slave; /* Address set on fd, -1 if none */
+	pthread_mutex_t lock; /* The slave address is per fd state */
+};
+
+static struct i2c_bus buses[I2C_BUS_MAX];
+
+static unsigned int buses_len;
+
+static pthread_mutex_t buses_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct i2c_bus *i2c_bus_get(const char *dev)
+{
+	struct i2c_bus *bus = NULL;
+
+	if (strlen(dev) >= I2C_BUS_PATH_MAX)
+		return NULL;
+
+	pthread_mutex_lock(&buses_lock);
+
+	for (unsigned int i = 0U; i < buses_len; ++i) {
+		if (strcmp(buses[i].path, dev) == 0) {
+			bus = &buses[i];
+			break;
+		}
+	}
+
+	if ((bus == NULL) && (buses_len < I2C_BUS_MAX)) {
+		bus = &buses[buses_len++];
+
+		strcpy(bus->path, dev);
+		bus->fd = -1;
+		bus->slave = -1;
+		pthread_mutex_init(&bus->lock, NULL);
+	}
+
+	pthread_mutex_unlock(&buses_lock);
+
+	return bus;
+}
+
+static void i2c_bus_disconnect(struct i2c_bus *bus)
+{
+	if (bus->fd >= 0)
+		close(bus->fd);
+
+	bus->fd = -1;
+	bus->slave = -1;
+}
+
+static int i2c_bus_connect(struct i2c_bus *bus, uint8_t adr)
+{
+	if (bus->fd < 0) {
+		bus->fd = open(bus->path, O_RDWR | O_CLOEXEC);
+
+		if (bus->fd < 0) {
+			perror("Could not open i2c device");
+			return -1;
+		}
+	}
+
+	if (bus->slave != adr) {
+		if (ioctl(bus->fd, I2C_SLAVE, adr) < 0) {
+			perror("Failed to acquire bus access and/or talk to slave");
+			i2c_bus_disconnect(bus);
+			return -1;
+		}
+
+		bus->slave = adr;
+	}
+
+	return 0;
+}
+
+/* A vanished adapter or a wedged transfer is retried once on a new fd */
+static bool i2c_bus_should_reconnect(int err)
+{
+	return (err == ENODEV) || (err == EIO);
+}
+
+/*
+ * Runs the messages of a transfer. Plain reads and writes go through
+ * read()/write() on the slave set by I2C_SLAVE, longer transactions through
+ * I2C_RDWR, which carries the address in each message. Returns 0, or the
+ * errno of the failure.
+ */
+static int i2c_bus_run(struct i2c_bus *bus, struct i2c_msg *msgs,
+		       unsigned int nmsgs)
+{
+	if (nmsgs > 1U) {
+		struct i2c_rdwr_ioctl_data rdwr = {
+			.msgs = msgs,
+			.nmsgs = nmsgs,
+		};
+
+		return (ioctl(bus->fd, I2C_RDWR, &rdwr) < 0) ? errno : 0;
+	}
+
+	ssize_t ret = (msgs[0].flags & I2C_M_RD) ?
+			      read(bus->fd, msgs[0].buf, msgs[0].len) :
+			      write(bus->fd, msgs[0].buf, msgs[0].len);
+
+	if (ret < 0)
+		return errno;
+
+	return (ret == msgs[0].len) ? 0 : EREMOTEIO;
+}
+
+static int i2c_bus_xfer(const char *dev, struct i2c_msg *msgs,
+			unsigned int nmsgs)
+{
+	struct i2c_bus *bus = i2c_bus_get(dev);
+	int err = -1;
+
+	if (bus == NULL)
+		return -1;
+
+	pthread_mutex_lock(&bus->lock);
+
+	for (unsigned int attempt = 0U; attempt < 2U; ++attempt) {
+		if (i2c_bus_connect(bus, (uint8_t)msgs[0].addr) != 0)
+			break;
+
+		int ret = i2c_bus_run(bus, msgs, nmsgs);
+
+		if (ret == 0) {
+			err = 0;
+			break;
+		}
+
+		if ((attempt > 0U) || !i2c_bus_should_reconnect(ret)) {
+			fprintf(stderr, "Could not transfer to i2c device: %s\n",
+				strerror(ret));
+			break;
+		}
+
+		i2c_bus_disconnect(bus);
+	}
+
+	pthread_mutex_unlock(&bus->lock);
+
+	return err;
+}
+
+int i2c_bus_write(const char *dev, uint8_t adr, const uint8_t *data,
+		  uint16_t len)
+{
+	struct i2c_msg msg = {
+		.addr = adr,
+		.flags = 0U,
+		.len = len,
+		.buf = (uint8_t *)data,
+	};
+
+	return i2c_bus_xfer(dev, &msg, 1U);
+}
+
+int i2c_bus_read(const char *dev, uint8_t adr, uint8_t *data, uint16_t len)
+{
+	struct i2c_msg msg = {
+		.addr = adr,
+		.flags = I2C_M_RD,
+		.len = len,
+		.buf = data,
+	};
+
+	return i2c_bus_xfer(dev, &msg, 1U);
+}
+
+int i2c_bus_transfer(const char *dev, struct i2c_msg *msgs, unsigned int nmsgs)
+{
+	if ((nmsgs == 0U) || (nmsgs > I2C_BUS_MSGS_MAX))
+		return -1;
+
+	return i2c_bus_xfer(dev, msgs, nmsgs);
+}
+
+/** \} End of i2c_bus group */
@@ -34,22 +34,12 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 
+#include <drivers/dev_timing.h>
 #include <drivers/sl_eps2.h>
-
-#define SL_EPS2_CRC8_INITIAL_VALUE 0U /**< CRC8-CCITT initial value. */
-#define SL_EPS2_CRC8_POLYNOMIAL 0x07U /**< CRC8-CCITT polynomial. */
-
-/**
- * \brief Computes the CRC-8 of a sequence of bytes.
- *
- * \param[in] data is an array of data to compute the CRC-8.
- *
- * \param[in] len is the number of bytes of the given array.
- *
- * \return The computed CRC-8 value of the given data.
- */
-static uint8_t sl_eps2_crc8(uint8_t *data, uint8_t len);
+#include <system/checksum.h>
 
 /**
  * \brief Checks the CRC value of a given sequence of bytes.
@@ -64,6 +54,25 @@ static uint8_t sl_eps2_crc8(uint8_t *data, uint8_t len);
  */
 static bool sl_eps2_check_crc(uint8_t *data, uint8_t len, uint8_t crc);
 
+static uint32_t sl_eps2_settle_time_ms[SL_EPS2_REG_CLASS_COUNT] = {
+    [SL_EPS2_REG_CLASS_CONFIG] = SL_EPS2_SETTLE_TIME_CONFIG_MS,
+    [SL_EPS2_REG_CLASS_MEASUREMENT] = SL_EPS2_SETTLE_TIME_MEASUREMENT_MS,
+    [SL_EPS2_REG_CLASS_BAT_MONITOR] = SL_EPS2_SETTLE_TIME_BAT_MONITOR_MS,
+};
+
+/* Replies are polled for up to twice the nominal settle time */
+static struct dev_timing sl_eps2_timing[SL_EPS2_REG_CLASS_COUNT] = {
+    [SL_EPS2_REG_CLASS_CONFIG] = DEV_TIMING_INIT(
+        "sl_eps2_config", SL_EPS2_RESPONSE_FLOOR_US,
+        2U * 1000U * SL_EPS2_SETTLE_TIME_CONFIG_MS),
+    [SL_EPS2_REG_CLASS_MEASUREMENT] = DEV_TIMING_INIT(
+        "sl_eps2_measurement", SL_EPS2_RESPONSE_FLOOR_US,
+        2U * 1000U * SL_EPS2_SETTLE_TIME_MEASUREMENT_MS),
+    [SL_EPS2_REG_CLASS_BAT_MONITOR] = DEV_TIMING_INIT(
+        "sl_eps2_bat_monitor", SL_EPS2_RESPONSE_FLOOR_US,
+        2U * 1000U * SL_EPS2_SETTLE_TIME_BAT_MONITOR_MS),
+};
+
 int sl_eps2_init(sl_eps2_config_t config) {
   int err = 0;
 
@@ -98,11 +107,8 @@ int sl_eps2_write_reg(sl_eps2_config_t config, uint8_t adr, uint32_t val) {
   uint8_t buf[1 + 4 + 1] = {0};
 
   buf[0] = adr;
-  buf[1] = (val >> 24) & 0xFFU;
-  buf[2] = (val >> 16) & 0xFFU;
-  buf[3] = (val >> 8) & 0xFFU;
-  buf[4] = (val >> 0) & 0xFFU;
-  buf[5] = sl_eps2_crc8(buf, 5);
+  sl_eps2_encode_reg(val, &buf[1]);
+  buf[5] = checksum_crc8(buf, 5);
 
   if (sl_eps2_i2c_write(config, buf, 6U) != SL_EPS2_OP_OK) {
     err = -1;
@@ -112,305 +118,261 @@ int sl_eps2_write_reg(sl_eps2_config_t config, uint8_t adr, uint32_t val) {
 }
 
 int sl_eps2_read_reg(sl_eps2_config_t config, uint8_t adr, uint32_t *val) {
+  int8_t status = SL_EPS2_REG_ERR_BUS;
 
-  int err = 0;
-
-  uint8_t buf[1 + 4 + 1] = {0};
-
-  buf[0] = adr;
-  buf[1] = sl_eps2_crc8(buf, 1);
-
-  if (sl_eps2_i2c_write(config, buf, 2U) != SL_EPS2_OP_OK) {
-    err = -1;
-  }
-
-  sl_eps2_delay_ms(50);
-
-  if (sl_eps2_i2c_read(config, buf, 6U) != SL_EPS2_OP_OK) {
-    err = -1;
-  }
-
-  if (!sl_eps2_check_crc(buf, 5U, buf[5])) {
-    err = -1;
-  }
-
-  *val = ((uint32_t)buf[1] << 24) | ((uint32_t)buf[2] << 16) |
-         ((uint32_t)buf[3] << 8) | ((uint32_t)buf[4] << 0);
-
-  return err;
+  return (sl_eps2_read_regs(config, &adr, 1U, val, &status) == 0) ? 0 : -1;
 }
 
-int sl_eps2_read_data(sl_eps2_config_t config, sl_eps2_data_t *data) {
-  int err_counter = 0;
-
-  /* Time counter */
-  if (sl_eps2_read_time_counter(config, &(data->time_counter)) != 0) {
-    err_counter++;
-  }
-
-  /* Temperature */
-  if (sl_eps2_read_temp(config, &(data->temperature_uc)) != 0) {
-    err_counter++;
-  }
-
-  /* Current */
-  if (sl_eps2_read_current(config, &(data->current)) != 0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  /* Last reset cause */
-  if (sl_eps2_read_reset_cause(config, &(data->last_reset_cause)) != 0) {
-    err_counter++;
-  }
-
-  /* Reset counter */
-  if (sl_eps2_read_reset_counter(config, &(data->reset_counter)) != 0) {
-    err_counter++;
-  }
-
-  /* Solar panel voltage */
-  if (sl_eps2_read_solar_panel_voltage(config, SL_EPS2_SOLAR_PANEL_3_0,
-                                       &(data->solar_panel_voltage_my_px)) !=
-      0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  if (sl_eps2_read_solar_panel_voltage(config, SL_EPS2_SOLAR_PANEL_1_4,
-                                       &(data->solar_panel_voltage_mx_pz)) !=
-      0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_voltage(config, SL_EPS2_SOLAR_PANEL_5_2,
-                                       &(data->solar_panel_voltage_mz_py)) !=
-      0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_voltage(config, SL_EPS2_SOLAR_PANEL_ALL,
-                                       &(data->solar_panel_output_voltage)) !=
-      0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  /* Solar panel current */
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_0,
-                                       &(data->solar_panel_current_my)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_1,
-                                       &(data->solar_panel_current_py)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_2,
-                                       &(data->solar_panel_current_mx)) != 0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_3,
-                                       &(data->solar_panel_current_px)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_4,
-                                       &(data->solar_panel_current_mz)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_solar_panel_current(config, SL_EPS2_SOLAR_PANEL_5,
-                                       &(data->solar_panel_current_pz)) != 0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  /* MPPT duty cycle */
-  if (sl_eps2_read_mppt_duty_cycle(config, SL_EPS2_MPPT_1,
-                                   &(data->mppt_1_duty_cycle)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_mppt_duty_cycle(config, SL_EPS2_MPPT_2,
-                                   &(data->mppt_2_duty_cycle)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_mppt_duty_cycle(config, SL_EPS2_MPPT_3,
-                                   &(data->mppt_3_duty_cycle)) != 0) {
-    err_counter++;
-  }
-
-  sl_eps2_delay_ms(5);
-
-  /* Main power bus voltage */
-  if (sl_eps2_read_main_bus_voltage(config, &(data->main_power_bus_voltage)) !=
-      0) {
-    err_counter++;
-  }
-
-  /* RTDs temperature */
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_0,
-                                   &(data->rtd_0_temperature)) != 0) {
-    err_counter++;
+/**
+ * \brief Runs the pending messages of a bulk read as one transaction.
+ *
+ * \param[in] reg is the register index of each read message, or
+ * SL_EPS2_READ_REGS_MAX for requests.
+ */
+static void sl_eps2_read_regs_flush(sl_eps2_config_t config,
+                                    sl_eps2_i2c_msg_t *msgs,
+                                    const uint8_t *reg, uint8_t *nmsgs,
+                                    int8_t *status) {
+  if (*nmsgs == 0U) {
+    return;
+  }
+
+  if (sl_eps2_i2c_transfer(config, msgs, *nmsgs) == SL_EPS2_OP_OK) {
+    uint8_t i = 0U;
+    for (i = 0U; i < *nmsgs; i++) {
+      if (reg[i] < SL_EPS2_READ_REGS_MAX) {
+        status[reg[i]] = SL_EPS2_REG_OK;
+      }
+    }
   }
 
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_1,
-                                   &(data->rtd_1_temperature)) != 0) {
-    err_counter++;
-  }
+  *nmsgs = 0U;
+}
 
-  sl_eps2_delay_ms(5);
+/**
+ * \brief Reply of a register request being polled.
+ */
+typedef struct {
+  sl_eps2_config_t config;
+  uint8_t adr;
+  uint8_t *rx;
+  int8_t *status;
+} sl_eps2_poll_t;
 
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_2,
-                                   &(data->rtd_2_temperature)) != 0) {
-    err_counter++;
-  }
+static int sl_eps2_poll_reply(void *arg) {
+  sl_eps2_poll_t *poll = (sl_eps2_poll_t *)arg;
+  sl_eps2_i2c_msg_t msg = {poll->rx, 1U + 4U + 1U, 1U};
 
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_3,
-                                   &(data->rtd_3_temperature)) != 0) {
-    err_counter++;
+  if (sl_eps2_i2c_transfer(poll->config, &msg, 1U) != SL_EPS2_OP_OK) {
+    *poll->status = SL_EPS2_REG_ERR_BUS;
+    return -1;
   }
 
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_4,
-                                   &(data->rtd_4_temperature)) != 0) {
-    err_counter++;
+  /* The reply echoes the address of the register */
+  if ((poll->rx[0] != poll->adr) ||
+      !sl_eps2_check_crc(poll->rx, 5U, poll->rx[5])) {
+    *poll->status = SL_EPS2_REG_ERR_CRC;
+    return DEV_TIMING_NOT_READY;
   }
 
-  sl_eps2_delay_ms(5);
+  *poll->status = SL_EPS2_REG_OK;
 
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_5,
-                                   &(data->rtd_5_temperature)) != 0) {
-    err_counter++;
-  }
-
-  if (sl_eps2_read_rtd_temperature(config, SL_EPS2_RTD_6,
-                                   &(data->rtd_6_temperature)) != 0) {
-    err_counter++;
+  /*
+   * The firmware holds the bus idle (all zeros) until the reply is ready,
+   * which is also a valid reply of register 0 holding 0.
+   */
+  bool idle = true;
+  uint8_t i = 0U;
+  for (i = 0U; i < (1U + 4U + 1U); i++) {
+    if (poll->rx[i] != 0U) {
+      idle = false;
+    }
   }
 
-  /* Battery voltage */
-  if (sl_eps2_read_battery_voltage(config, &(data->battery_voltage)) != 0) {
-    err_counter++;
-  }
+  return idle ? DEV_TIMING_STALE : 0;
+}
 
-  sl_eps2_delay_ms(5);
+int sl_eps2_read_regs(sl_eps2_config_t config, const uint8_t *adr,
+                      uint8_t count, uint32_t *val, int8_t *status) {
+  uint8_t tx[SL_EPS2_READ_REGS_MAX][1 + 1];
+  uint8_t rx[SL_EPS2_READ_REGS_MAX][1 + 4 + 1];
+  sl_eps2_i2c_msg_t msgs[SL_EPS2_I2C_MSGS_MAX];
+  uint8_t reg[SL_EPS2_I2C_MSGS_MAX];
+  uint8_t nmsgs = 0U;
+  int err_counter = 0;
 
-  /* Battery current */
-  if (sl_eps2_read_battery_current(config, SL_EPS2_BATTERY_CURRENT,
-                                   &(data->battery_current)) != 0) {
-    err_counter++;
+  if (count > SL_EPS2_READ_REGS_MAX) {
+    return -1;
   }
 
-  if (sl_eps2_read_battery_current(config, SL_EPS2_BATTERY_AVERAGE_CURRENT,
-                                   &(data->battery_average_current)) != 0) {
-    err_counter++;
-  }
+  uint8_t i = 0U;
+  for (i = 0U; i < count; i++) {
+    status[i] = SL_EPS2_REG_ERR_BUS;
 
-  if (sl_eps2_read_battery_current(config, SL_EPS2_BATTERY_ACC_CURRENT,
-                                   &(data->battery_acc_current)) != 0) {
-    err_counter++;
-  }
+    tx[i][0] = adr[i];
+    tx[i][1] = checksum_crc8(tx[i], 1);
 
-  sl_eps2_delay_ms(5);
+    if ((nmsgs + 2U) > SL_EPS2_I2C_MSGS_MAX) {
+      sl_eps2_read_regs_flush(config, msgs, reg, &nmsgs, status);
+    }
 
-  /* Battery charge */
-  if (sl_eps2_read_battery_charge(config, &(data->battery_charge)) != 0) {
-    err_counter++;
-  }
+    msgs[nmsgs] = (sl_eps2_i2c_msg_t){tx[i], sizeof(tx[i]), 0U};
+    reg[nmsgs++] = SL_EPS2_READ_REGS_MAX;
 
-  /* Battery monitor */
-  if (sl_eps2_read_battery_monitor_temp(
-          config, &(data->battery_monitor_temperature)) != 0) {
-    err_counter++;
-  }
+    uint8_t reg_class = sl_eps2_get_reg_class(adr[i]);
 
-  if (sl_eps2_read_battery_monitor_status(
-          config, &(data->battery_monitor_status)) != 0) {
-    err_counter++;
-  }
+    /* The reply is polled for alone, until it is ready */
+    if (sl_eps2_settle_time_ms[reg_class] != 0U) {
+      sl_eps2_read_regs_flush(config, msgs, reg, &nmsgs, status);
 
-  sl_eps2_delay_ms(5);
+      sl_eps2_poll_t poll = {config, adr[i], rx[i], &status[i]};
+      (void)dev_timing_wait(&sl_eps2_timing[reg_class], sl_eps2_poll_reply,
+                            &poll);
+      continue;
+    }
 
-  if (sl_eps2_read_battery_monitor_protection(
-          config, &(data->battery_monitor_protection)) != 0) {
-    err_counter++;
+    msgs[nmsgs] = (sl_eps2_i2c_msg_t){rx[i], sizeof(rx[i]), 1U};
+    reg[nmsgs++] = i;
   }
 
-  if (sl_eps2_read_battery_monitor_cycle_counter(
-          config, &(data->battery_monitor_cycle_counter)) != 0) {
-    err_counter++;
-  }
+  sl_eps2_read_regs_flush(config, msgs, reg, &nmsgs, status);
 
-  if (sl_eps2_read_battery_monitor_raac(config, &(data->raac)) != 0) {
-    err_counter++;
-  }
+  for (i = 0U; i < count; i++) {
+    if ((status[i] == SL_EPS2_REG_OK) &&
+        !sl_eps2_check_crc(rx[i], 5U, rx[i][5])) {
+      status[i] = SL_EPS2_REG_ERR_CRC;
+    }
 
-  sl_eps2_delay_ms(5);
+    if (status[i] != SL_EPS2_REG_OK) {
+      err_counter++;
+      continue;
+    }
 
-  if (sl_eps2_read_battery_monitor_rsac(config, &(data->rsac)) != 0) {
-    err_counter++;
+    val[i] = sl_eps2_decode_reg(&rx[i][1]);
   }
 
-  if (sl_eps2_read_battery_monitor_rarc(config, &(data->rarc)) != 0) {
-    err_counter++;
-  }
+  return err_counter;
+}
 
-  if (sl_eps2_read_battery_monitor_rsrc(config, &(data->rsrc)) != 0) {
-    err_counter++;
+int sl_eps2_set_settle_time(uint8_t reg_class, uint32_t ms) {
+  if (reg_class >= SL_EPS2_REG_CLASS_COUNT) {
+    return -1;
   }
 
-  sl_eps2_delay_ms(5);
+  sl_eps2_settle_time_ms[reg_class] = ms;
+  sl_eps2_timing[reg_class].limit_us = 2U * 1000U * ms;
 
-  /* Heater duty cycle */
-  if (sl_eps2_read_heater_duty_cycle(config, SL_EPS2_HEATER_1,
-                                     (&data->battery_heater_1_duty_cycle)) !=
-      0) {
-    err_counter++;
-  }
+  return 0;
+}
 
-  if (sl_eps2_read_heater_duty_cycle(config, SL_EPS2_HEATER_2,
-                                     (&data->battery_heater_2_duty_cycle)) !=
-      0) {
-    err_counter++;
-  }
+/**
+ * \brief Register backing a field of sl_eps2_data_t.
+ */
+typedef struct {
+  uint8_t adr;
+  uint16_t offset; /**< The field has the width of the register. */
+} sl_eps2_data_reg_t;
+
+#define SL_EPS2_DATA_REG(reg, field)                                           \
+  { (reg), offsetof(sl_eps2_data_t, field) }
+
+static const sl_eps2_data_reg_t sl_eps2_data_regs[] = {
+    SL_EPS2_DATA_REG(SL_EPS2_REG_TIME_COUNTER_MS, time_counter),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_UC_TEMPERATURE_K, temperature_uc),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_CURRENT_MA, current),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_LAST_RESET_CAUSE, last_reset_cause),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RESET_COUNTER, reset_counter),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MY_PX_VOLT_MV,
+                     solar_panel_voltage_my_px),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MX_PZ_VOLT_MV,
+                     solar_panel_voltage_mx_pz),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MZ_PY_VOLT_MV,
+                     solar_panel_voltage_mz_py),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_TOTAL_VOLT_MV,
+                     solar_panel_output_voltage),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MY_CUR_MA, solar_panel_current_my),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_PY_CUR_MA, solar_panel_current_py),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MX_CUR_MA, solar_panel_current_mx),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_PX_CUR_MA, solar_panel_current_px),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_MZ_CUR_MA, solar_panel_current_mz),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_SOLAR_PANEL_PZ_CUR_MA, solar_panel_current_pz),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_1_DUTY_CYCLE, mppt_1_duty_cycle),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_2_DUTY_CYCLE, mppt_2_duty_cycle),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_3_DUTY_CYCLE, mppt_3_duty_cycle),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MAIN_POWER_BUS_VOLT_MV, main_power_bus_voltage),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD0_TEMP_K, rtd_0_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD1_TEMP_K, rtd_1_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD2_TEMP_K, rtd_2_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD3_TEMP_K, rtd_3_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD4_TEMP_K, rtd_4_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD5_TEMP_K, rtd_5_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_RTD6_TEMP_K, rtd_6_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BATTERY_VOLT_MV, battery_voltage),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BATTERY_CUR_MA, battery_current),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BATTERY_AVEG_CUR_MA, battery_average_current),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BATTERY_ACC_CUR_MA, battery_acc_current),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BATTERY_CHARGE_MAH, battery_charge),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_TEMP_K,
+                     battery_monitor_temperature),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_STATUS, battery_monitor_status),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_PROTECTION,
+                     battery_monitor_protection),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_CYCLE_COUNTER,
+                     battery_monitor_cycle_counter),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_RAAC_MAH, raac),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_RSAC_MAH, rsac),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_RARC_PERC, rarc),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_MONITOR_RSRC_PERC, rsrc),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
+                     battery_heater_1_duty_cycle),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
+                     battery_heater_2_duty_cycle),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_1_MODE, mppt_1_mode),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_2_MODE, mppt_2_mode),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_MPPT_3_MODE, mppt_3_mode),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_HEATER_1_MODE, battery_heater_1_mode),
+    SL_EPS2_DATA_REG(SL_EPS2_REG_BAT_HEATER_2_MODE, battery_heater_2_mode),
+};
+
+#define SL_EPS2_DATA_REGS_COUNT                                                \
+  (sizeof(sl_eps2_data_regs) / sizeof(sl_eps2_data_regs[0]))
 
-  /* MPPT mode */
-  if (sl_eps2_get_mppt_mode(config, SL_EPS2_MPPT_1, &(data->mppt_1_mode)) !=
-      0) {
-    err_counter++;
-  }
+int sl_eps2_read_data(sl_eps2_config_t config, sl_eps2_data_t *data) {
+  uint8_t adr[SL_EPS2_DATA_REGS_COUNT];
+  uint32_t val[SL_EPS2_DATA_REGS_COUNT];
+  int8_t status[SL_EPS2_DATA_REGS_COUNT];
 
-  if (sl_eps2_get_mppt_mode(config, SL_EPS2_MPPT_2, &(data->mppt_2_mode)) !=
-      0) {
-    err_counter++;
+  uint8_t i = 0U;
+  for (i = 0U; i < SL_EPS2_DATA_REGS_COUNT; i++) {
+    adr[i] = sl_eps2_data_regs[i].adr;
   }
 
-  sl_eps2_delay_ms(5);
+  int err_counter =
+      sl_eps2_read_regs(config, adr, SL_EPS2_DATA_REGS_COUNT, val, status);
 
-  if (sl_eps2_get_mppt_mode(config, SL_EPS2_MPPT_3, &(data->mppt_3_mode)) !=
-      0) {
-    err_counter++;
-  }
+  for (i = 0U; i < SL_EPS2_DATA_REGS_COUNT; i++) {
+    if (status[i] != SL_EPS2_REG_OK) {
+      continue;
+    }
 
-  /* Heater mode */
-  if (sl_eps2_get_heater_mode(config, SL_EPS2_HEATER_1,
-                              &(data->battery_heater_1_mode)) != 0) {
-    err_counter++;
-  }
+    uint8_t *field = (uint8_t *)data + sl_eps2_data_regs[i].offset;
 
-  if (sl_eps2_get_heater_mode(config, SL_EPS2_HEATER_2,
-                              &(data->battery_heater_2_mode)) != 0) {
-    err_counter++;
+    /* Same truncation as the single register read functions */
+    switch (sl_eps2_get_reg_width(sl_eps2_data_regs[i].adr)) {
+    case sizeof(uint8_t): {
+      uint8_t v = (uint8_t)val[i];
+      memcpy(field, &v, sizeof(v));
+      break;
+    }
+    case sizeof(uint16_t): {
+      uint16_t v = (uint16_t)val[i];
+      memcpy(field, &v, sizeof(v));
+      break;
+    }
+    default:
+      memcpy(field, &val[i], sizeof(val[i]));
+      break;
+    }
   }
 
   return err_counter;
@@ -967,26 +929,8 @@ int sl_eps2_get_heater_mode(sl_eps2_config_t config, uint8_t heater,
   return res;
 }
 
-static uint8_t sl_eps2_crc8(uint8_t *data, uint8_t len) {
-  uint8_t crc = SL_EPS2_CRC8_INITIAL_VALUE;
-
-  uint8_t i = 0U;
-  for (i = 0; i < len; i++) {
-    crc ^= data[i];
-
-    uint8_t j = 0U;
-    for (j = 0U; j < 8U; j++) {
-      crc = (crc << 1) ^ ((crc & 0x80U) ? SL_EPS2_CRC8_POLYNOMIAL : 0U);
-    }
-
-    crc &= 0xFFU;
-  }
-
-  return crc;
-}
-
 static bool sl_eps2_check_crc(uint8_t *data, uint8_t len, uint8_t crc) {
-  return (crc == sl_eps2_crc8(data, len));
+  return (crc == checksum_crc8(data, len));
 }
 
 /** \} End of sl_eps2 group */
@@ -33,13 +33,9 @@
  * \{
  */
 
-#include <fcntl.h>
-#include <linux/i2c-dev.h>
-#include <stdio.h>
-#include <sys/ioctl.h>
-#include <sys/stat.h>
 #include <unistd.h>
 
+#include <drivers/i2c_bus.h>
 #include <drivers/sl_eps2.h>
 
 #define I2C_CTRL_PATH "/dev/i2c-2"
@@ -58,56 +54,30 @@ int sl_eps2_i2c_init(sl_eps2_config_t config)
 
 int sl_eps2_i2c_write(sl_eps2_config_t config, uint8_t *data, uint16_t len)
 {
-	int fd;
-
-	fd = open(I2C_CTRL_PATH, O_WRONLY);
-
-	if (fd < 0) {
-		perror("Could not open i2c device");
-		return -1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, SL_EPS2_I2C_SLAVE_ADR) < 0) {
-		perror("Failed to acquire bus access and/or talk to slave");
-		close(fd);
-		return -1;
-	}
-
-	if (write(fd, data, len) != len) {
-		perror("Could not write to i2c device");
-		close(fd);
-		return -1;
-	}
-
-	close(fd);
-	return 0;
+	return i2c_bus_write(I2C_CTRL_PATH, SL_EPS2_I2C_SLAVE_ADR, data, len);
 }
 
 int sl_eps2_i2c_read(sl_eps2_config_t config, uint8_t *data, uint16_t len)
 {
-	int fd;
-
-	fd = open(I2C_CTRL_PATH, O_RDONLY);
+	return i2c_bus_read(I2C_CTRL_PATH, SL_EPS2_I2C_SLAVE_ADR, data, len);
+}
 
-	if (fd < 0) {
-		perror("Could not open i2c device");
-		return -1;
-	}
+int sl_eps2_i2c_transfer(sl_eps2_config_t config, sl_eps2_i2c_msg_t *msgs,
+			 uint8_t nmsgs)
+{
+	struct i2c_msg i2c_msgs[SL_EPS2_I2C_MSGS_MAX];
 
-	if (ioctl(fd, I2C_SLAVE, SL_EPS2_I2C_SLAVE_ADR) < 0) {
-		perror("Failed to acquire bus access and/or talk to slave");
-		close(fd);
+	if (nmsgs > SL_EPS2_I2C_MSGS_MAX)
 		return -1;
-	}
 
-	if (read(fd, data, len) != len) {
-		perror("Could not read to i2c device");
-		close(fd);
-		return -1;
+	for (uint8_t i = 0U; i < nmsgs; ++i) {
+		i2c_msgs[i].addr = SL_EPS2_I2C_SLAVE_ADR;
+		i2c_msgs[i].flags = msgs[i].rd ? I2C_M_RD : 0U;
+		i2c_msgs[i].len = msgs[i].len;
+		i2c_msgs[i].buf = msgs[i].data;
 	}
 
-	close(fd);
-	return 0;
+	return i2c_bus_transfer(I2C_CTRL_PATH, i2c_msgs, nmsgs);
 }
 
 /** \} End of sl_eps2 group */
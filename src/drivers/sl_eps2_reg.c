@@ -0,0 +1,140 @@
+/*
+ * sl_eps2_reg.c
+ *
+ * Copyright The OBDH 2.0 Contributors.
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief SpaceLab EPS 2.0 driver register codec.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \addtogroup sl_eps2
+ * \{
+ */
+
+#include <drivers/sl_eps2.h>
+
+/*
+ * Every register is sent as 4 bytes, MSB first. The width is the number of
+ * low bytes the typed reads and sl_eps2_read_data() keep, while the raw
+ * register reads return all of them.
+ */
+
+/**
+ * \brief Register descriptor.
+ */
+typedef struct {
+  uint8_t reg_class; /**< SL_EPS2_REG_CLASS_*. */
+  uint8_t width;     /**< Bytes of the value kept by the typed reads. */
+} sl_eps2_reg_desc_t;
+
+#define SL_EPS2_REG_DESC(adr, cls, w)                                          \
+  [(adr)] = {SL_EPS2_REG_CLASS_##cls, (w)}
+
+static const sl_eps2_reg_desc_t sl_eps2_regs[SL_EPS2_REG_COUNT] = {
+    SL_EPS2_REG_DESC(SL_EPS2_REG_TIME_COUNTER_MS, MEASUREMENT, 4U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_UC_TEMPERATURE_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_CURRENT_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_LAST_RESET_CAUSE, MEASUREMENT, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RESET_COUNTER, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MY_PX_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MX_PZ_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MZ_PY_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MY_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_PY_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MX_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_PX_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_MZ_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_PZ_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_1_DUTY_CYCLE, MEASUREMENT, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_2_DUTY_CYCLE, MEASUREMENT, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_3_DUTY_CYCLE, MEASUREMENT, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_SOLAR_PANEL_TOTAL_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MAIN_POWER_BUS_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD0_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD1_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD2_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD3_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD4_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD5_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RTD6_TEMP_K, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BATTERY_VOLT_MV, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BATTERY_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BATTERY_AVEG_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BATTERY_ACC_CUR_MA, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BATTERY_CHARGE_MAH, MEASUREMENT, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_TEMP_K, BAT_MONITOR, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_STATUS, BAT_MONITOR, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_PROTECTION, BAT_MONITOR, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_CYCLE_COUNTER, BAT_MONITOR, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_RAAC_MAH, BAT_MONITOR, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_RSAC_MAH, BAT_MONITOR, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_RARC_PERC, BAT_MONITOR, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_MONITOR_RSRC_PERC, BAT_MONITOR, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_HARDWARE_VERSION, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_FIRMWARE_VERSION, CONFIG, 4U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_1_MODE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_2_MODE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_MPPT_3_MODE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_HEATER_1_MODE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BAT_HEATER_2_MODE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_DEVICE_ID, CONFIG, 2U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_RESET_EPS, CONFIG, 4U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_PAYLOAD_ENABLE, CONFIG, 1U),
+    SL_EPS2_REG_DESC(SL_EPS2_REG_BEACON_ENABLE, CONFIG, 1U),
+};
+
+/* Unknown registers are passed through as 32-bit configuration values */
+static const sl_eps2_reg_desc_t sl_eps2_reg_default = {SL_EPS2_REG_CLASS_CONFIG,
+                                                       4U};
+
+static const sl_eps2_reg_desc_t *sl_eps2_get_reg_desc(uint8_t adr) {
+  return (adr < SL_EPS2_REG_COUNT) ? &sl_eps2_regs[adr] : &sl_eps2_reg_default;
+}
+
+uint8_t sl_eps2_get_reg_class(uint8_t adr) {
+  return sl_eps2_get_reg_desc(adr)->reg_class;
+}
+
+uint8_t sl_eps2_get_reg_width(uint8_t adr) {
+  return sl_eps2_get_reg_desc(adr)->width;
+}
+
+void sl_eps2_encode_reg(uint32_t val, uint8_t *buf) {
+  buf[0] = (val >> 24) & 0xFFU;
+  buf[1] = (val >> 16) & 0xFFU;
+  buf[2] = (val >> 8) & 0xFFU;
+  buf[3] = (val >> 0) & 0xFFU;
+}
+
+uint32_t sl_eps2_decode_reg(const uint8_t *buf) {
+  uint32_t val = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+                 ((uint32_t)buf[2] << 8) | ((uint32_t)buf[3] << 0);
+
+  return val;
+}
+
+/** \} End of sl_eps2 group */
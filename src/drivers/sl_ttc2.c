@@ -36,31 +36,61 @@
 
 #include <string.h>
 
+#include <system/checksum.h>
 #include <system/sys_log.h>
+#include <drivers/dev_timing.h>
 #include <drivers/sl_ttc2.h>
 
-#define CRC8_INITIAL_VAL 0x00U /* CRC8-CCITT initial value. */
-#define CRC8_POLYNOMIAL 0x07U /* CRC8-CCITT polynomial. */
+static struct dev_timing sl_ttc2_timing[] = {
+	[SL_TTC2_RADIO_0] = DEV_TIMING_INIT("sl_ttc2_radio_0",
+					    SL_TTC2_RESPONSE_FLOOR_US,
+					    SL_TTC2_RESPONSE_LIMIT_MS * 1000U),
+	[SL_TTC2_RADIO_1] = DEV_TIMING_INIT("sl_ttc2_radio_1",
+					    SL_TTC2_RESPONSE_FLOOR_US,
+					    SL_TTC2_RESPONSE_LIMIT_MS * 1000U),
+};
 
-static uint8_t crc8_get_val(uint8_t *data, uint8_t len)
-{
-	uint8_t crc = CRC8_INITIAL_VAL;
-	uint8_t i = 0U;
-	uint8_t j = 0U;
+/* Per radio, guarded by the radio mutex */
+static uint64_t sl_ttc2_sent_us[SL_TTC2_RADIOS_MAX]; /* Last request sent */
+static uint64_t sl_ttc2_ready_us[SL_TTC2_RADIOS_MAX]; /* End of the last gap */
 
-	for (i = 0U; i < len; i++) {
-		crc ^= data[i];
+/**
+ * \brief Poll of the reply of a register read.
+ */
+struct sl_ttc2_poll {
+	sl_ttc2_config_t *config;
+	uint8_t adr;
+	uint8_t *wbuf;
+	uint8_t *rbuf;
+	uint32_t *val;
+};
+
+static uint8_t sl_ttc2_radio(const sl_ttc2_config_t *config)
+{
+	return (config->id == SL_TTC2_RADIO_1) ? SL_TTC2_RADIO_1 :
+						 SL_TTC2_RADIO_0;
+}
 
-		j = 0U;
-		for (j = 0U; j < 8U; j++) {
-			crc = (crc << 1) ^
-			      ((crc & 0x80U) ? CRC8_POLYNOMIAL : 0U);
-		}
+/* Waits for the gap after the previous transaction with the radio */
+static void sl_ttc2_wait_ready(uint8_t radio)
+{
+	uint64_t now = dev_timing_now_us();
 
-		crc &= 0xFFU;
+	if (sl_ttc2_ready_us[radio] > now) {
+		sl_ttc2_delay_ms(
+			(uint32_t)((sl_ttc2_ready_us[radio] - now + 999U) /
+				   1000U));
 	}
+}
 
-	return crc;
+/*
+ * Ends a transaction. The gap the TTC needs before the next request is
+ * waited for by that request, with no lock held but the radio's.
+ */
+static void sl_ttc2_set_done(uint8_t radio)
+{
+	sl_ttc2_ready_us[radio] =
+		dev_timing_now_us() + (SL_TTC2_EXTRA_MUTEX_DELAY_MS * 1000U);
 }
 
 int sl_ttc2_init(sl_ttc2_config_t *config)
@@ -125,326 +155,278 @@ int sl_ttc2_write_reg(sl_ttc2_config_t *config, uint8_t adr, uint32_t val)
 	buf[2] = adr;
 
 	/* Register data */
-	switch (adr) {
-	case SL_TTC2_REG_DEVICE_ID:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_HARDWARE_VERSION:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_RESET_COUNTER:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_LAST_RESET_CAUSE:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_INPUT_VOLTAGE_MCU:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_INPUT_CURRENT_MCU:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_TEMPERATURE_MCU:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_INPUT_VOLTAGE_RADIO:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_INPUT_CURRENT_RADIO:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_TEMPERATURE_RADIO:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_LAST_VALID_TC:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_RSSI_LAST_VALID_TC:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_TEMPERATURE_ANTENNA:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_ANTENNA_STATUS:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_TX_ENABLE:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_FIFO_TX_PACKET:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_FIFO_RX_PACKET:
-		buf[3] = val & 0xFFU;
-		break;
-	case SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO:
-		buf[3] = (val >> 8) & 0xFFU;
-		buf[4] = (val >> 0) & 0xFFU;
-		break;
-	case SL_TTC2_REG_RESET_DEVICE:
-		buf[3] = val & 0xFFU;
-		break;
-	default:
-		buf[3] = (val >> 24) & 0xFFU;
-		buf[4] = (val >> 16) & 0xFFU;
-		buf[5] = (val >> 8) & 0xFFU;
-		buf[6] = (val >> 0) & 0xFFU;
-		break;
-	}
+	sl_ttc2_encode_reg(adr, val, &buf[3]);
+
+	buf[7] = checksum_crc8(buf, 7U);
+
+	uint8_t radio = sl_ttc2_radio(config);
 
-	buf[7] = crc8_get_val(buf, 7U);
+	if (sl_ttc2_radio_mutex_take(radio) == 0) {
+		sl_ttc2_wait_ready(radio);
 
-	if (sl_ttc2_mutex_take() == 0) {
 		err = sl_ttc2_spi_write(config, buf, 8U);
 
-		sl_ttc2_delay_ms(SL_TTC2_EXTRA_MUTEX_DELAY_MS);
+		sl_ttc2_set_done(radio);
 
-		(void)sl_ttc2_mutex_give();
+		(void)sl_ttc2_radio_mutex_give(radio);
 	}
 
 	return err;
 }
 
+/* Checks a register read reply and extracts the value from it */
+static int sl_ttc2_check_reply(uint8_t adr, uint8_t *rbuf, uint32_t *val)
+{
+	if ((checksum_crc8(rbuf, 7U) != rbuf[7]) ||
+	    (rbuf[0] != SL_TTC2_PKT_PREAMBLE) ||
+	    (rbuf[1] != SL_TTC2_CMD_READ_REG) || (rbuf[2] != adr)) {
+		return -1;
+	}
+
+	*val = sl_ttc2_decode_reg(adr, &rbuf[3]);
+
+	return 0;
+}
+
 int sl_ttc2_read_reg(sl_ttc2_config_t *config, uint8_t adr, uint32_t *val)
 {
-	int err = -1;
+	return (sl_ttc2_read_regs(config, &adr, 1U, val) == 0) ? 0 : -1;
+}
 
-	uint8_t wbuf[8] = { 0 };
-	uint8_t rbuf[8] = { 0 };
+static int sl_ttc2_poll_reply(void *arg)
+{
+	struct sl_ttc2_poll *poll = arg;
+
+	if (sl_ttc2_spi_transfer(poll->config, poll->wbuf, poll->rbuf, 8U) !=
+	    0) {
+		return -1;
+	}
+
+	if (sl_ttc2_check_reply(poll->adr, poll->rbuf, poll->val) != 0) {
+		return DEV_TIMING_NOT_READY;
+	}
+
+	return 0;
+}
+
+int sl_ttc2_read_reg_begin(sl_ttc2_config_t *config, uint8_t adr)
+{
+	uint8_t buf[8] = { 0 };
+
+	uint8_t radio = sl_ttc2_radio(config);
 
 	/* Adding preamble byte */
-	wbuf[0] = SL_TTC2_PKT_PREAMBLE;
+	buf[0] = SL_TTC2_PKT_PREAMBLE;
 
 	/* Command ID */
-	wbuf[1] = SL_TTC2_CMD_READ_REG;
+	buf[1] = SL_TTC2_CMD_READ_REG;
 
 	/* Register address */
-	wbuf[2] = adr;
+	buf[2] = adr;
 
-	wbuf[7] = crc8_get_val(wbuf, 7U);
+	buf[7] = checksum_crc8(buf, 7U);
 
-	if (sl_ttc2_mutex_take() == 0) {
-		/* Register data */
-		if (sl_ttc2_spi_write(config, wbuf, 8U) == 0) {
-			sl_ttc2_delay_ms(SL_TTC2_TRANSACTION_DELAY_MS);
+	sl_ttc2_wait_ready(radio);
 
-			if (sl_ttc2_spi_read(config, rbuf, 8U) == 0) {
-				if (crc8_get_val(rbuf, 7U) == rbuf[7]) {
-					if ((rbuf[0] == SL_TTC2_PKT_PREAMBLE) &&
-					    (rbuf[1] == SL_TTC2_CMD_READ_REG) &&
-					    (rbuf[2] == adr)) {
-						uint32_t val_buf =
-							((uint32_t)rbuf[3]
-							 << 24) |
-							((uint32_t)rbuf[4]
-							 << 16) |
-							((uint32_t)rbuf[5]
-							 << 8) |
-							((uint32_t)rbuf[6]
-							 << 0);
-
-						switch (adr) {
-						case SL_TTC2_REG_DEVICE_ID:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_HARDWARE_VERSION:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_RESET_COUNTER:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_LAST_RESET_CAUSE:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_INPUT_VOLTAGE_MCU:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_INPUT_CURRENT_MCU:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_TEMPERATURE_MCU:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_INPUT_VOLTAGE_RADIO:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_INPUT_CURRENT_RADIO:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_TEMPERATURE_RADIO:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_LAST_VALID_TC:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_RSSI_LAST_VALID_TC:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_TEMPERATURE_ANTENNA:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_ANTENNA_STATUS:
-							*val = val_buf >> 16;
-							break;
-						case SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_TX_ENABLE:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_FIFO_TX_PACKET:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_FIFO_RX_PACKET:
-							*val = val_buf >> 24;
-							break;
-						case SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO:
-							*val = val_buf >> 16;
-							break;
-						default:
-							*val = val_buf;
-							break;
-						}
+	int err = sl_ttc2_spi_write(config, buf, 8U);
 
-						err = 0;
-					}
-				}
-			}
-		}
-
-		sl_ttc2_delay_ms(SL_TTC2_EXTRA_MUTEX_DELAY_MS);
+	sl_ttc2_sent_us[radio] = dev_timing_now_us();
 
-		(void)sl_ttc2_mutex_give();
+	if (err != 0) {
+		sl_ttc2_set_done(radio);
 	}
 
 	return err;
 }
 
-int sl_ttc2_read_hk_data(sl_ttc2_config_t *config, sl_ttc2_hk_data_t *data)
+int sl_ttc2_read_reg_end(sl_ttc2_config_t *config, uint8_t adr, uint32_t *val)
 {
-	int err_counter = 0;
+	uint8_t wbuf[8] = { 0 };
+	uint8_t rbuf[8] = { 0 };
 
-	/* Time counter */
-	if (sl_ttc2_read_time_counter(config, &(data->time_counter)) != 0) {
-		err_counter++;
-	}
+	uint8_t radio = sl_ttc2_radio(config);
 
-	/* Reset counter */
-	if (sl_ttc2_read_reset_counter(config, &(data->reset_counter)) != 0) {
-		err_counter++;
-	}
+	/* Bytes written while reading the reply */
+	wbuf[0] = SL_TTC2_PKT_PREAMBLE;
+	wbuf[7] = checksum_crc8(wbuf, 7U);
 
-	/* Last reset cause */
-	if (sl_ttc2_read_reset_cause(config, &(data->last_reset_cause)) != 0) {
-		err_counter++;
-	}
+	struct sl_ttc2_poll poll = {
+		.config = config,
+		.adr = adr,
+		.wbuf = wbuf,
+		.rbuf = rbuf,
+		.val = val,
+	};
 
-	sl_ttc2_delay_ms(5);
+	int err = dev_timing_wait_from(&sl_ttc2_timing[radio],
+				       sl_ttc2_sent_us[radio],
+				       sl_ttc2_poll_reply, &poll);
 
-	/* MCU power */
-	if (sl_ttc2_read_voltage(config, SL_TTC2_VOLTAGE_MCU,
-				 &(data->voltage_mcu)) != 0) {
-		err_counter++;
-	}
+	sl_ttc2_set_done(radio);
 
-	if (sl_ttc2_read_current(config, SL_TTC2_CURRENT_MCU,
-				 &(data->current_mcu)) != 0) {
-		err_counter++;
-	}
+	return err;
+}
 
-	/* MCU temperature */
-	if (sl_ttc2_read_temp(config, SL_TTC2_TEMP_MCU,
-			      &(data->temperature_mcu)) != 0) {
-		err_counter++;
+int sl_ttc2_read_regs(sl_ttc2_config_t *config, const uint8_t *adr,
+		      uint8_t count, uint32_t *val)
+{
+	sl_ttc2_read_t read = {
+		.config = config,
+		.adr = adr,
+		.count = count,
+		.val = val,
+	};
+
+	if (count == 0U) {
+		return -1;
 	}
 
-	sl_ttc2_delay_ms(5);
+	return (sl_ttc2_read_regs_multi(&read, 1U) == 0) ? read.failed : -1;
+}
+
+int sl_ttc2_read_regs_multi(sl_ttc2_read_t *reads, uint8_t n)
+{
+	bool used[SL_TTC2_RADIOS_MAX] = { false };
+	uint8_t max = 0U;
 
-	/* Radio power */
-	if (sl_ttc2_read_voltage(config, SL_TTC2_VOLTAGE_RADIO,
-				 &(data->voltage_radio)) != 0) {
-		err_counter++;
+	if ((n == 0U) || (n > SL_TTC2_RADIOS_MAX)) {
+		return -1;
 	}
 
-	if (sl_ttc2_read_current(config, SL_TTC2_CURRENT_RADIO,
-				 &(data->current_radio)) != 0) {
-		err_counter++;
+	for (uint8_t r = 0U; r < n; r++) {
+		uint8_t radio = sl_ttc2_radio(reads[r].config);
+
+		if (used[radio]) {
+			return -1;
+		}
+
+		used[radio] = true;
+		reads[r].failed = reads[r].count;
+
+		if (reads[r].count > max) {
+			max = reads[r].count;
+		}
 	}
 
-	/* Radio temperature */
-	if (sl_ttc2_read_temp(config, SL_TTC2_TEMP_RADIO,
-			      &(data->temperature_radio)) != 0) {
-		err_counter++;
+	/* Taken in radio order, as ttc_lock() does */
+	for (uint8_t radio = 0U; radio < SL_TTC2_RADIOS_MAX; radio++) {
+		if (used[radio]) {
+			(void)sl_ttc2_radio_mutex_take(radio);
+		}
 	}
 
-	sl_ttc2_delay_ms(5);
+	/* Every radio gets its request before any reply is waited for */
+	for (uint8_t i = 0U; i < max; i++) {
+		bool sent[SL_TTC2_RADIOS_MAX] = { false };
 
-	/* Last valid telecommand */
-	if (sl_ttc2_read_last_valid_tc(config, &(data->last_valid_tc)) != 0) {
-		err_counter++;
-	}
+		for (uint8_t r = 0U; r < n; r++) {
+			if (i < reads[r].count) {
+				sent[r] = (sl_ttc2_read_reg_begin(
+						   reads[r].config,
+						   reads[r].adr[i]) == 0);
+			}
+		}
 
-	/* RSSI */
-	if (sl_ttc2_read_rssi(config, &(data->rssi_last_valid_tc)) != 0) {
-		err_counter++;
+		for (uint8_t r = 0U; r < n; r++) {
+			if (sent[r] &&
+			    (sl_ttc2_read_reg_end(reads[r].config,
+						  reads[r].adr[i],
+						  &reads[r].val[i]) == 0)) {
+				reads[r].failed--;
+			}
+		}
 	}
 
-	/* Antenna data */
-	if (sl_ttc2_read_temp(config, SL_TTC2_TEMP_ANTENNA,
-			      &(data->temperature_antenna)) != 0) {
-		err_counter++;
+	for (uint8_t radio = SL_TTC2_RADIOS_MAX; radio-- > 0U;) {
+		if (used[radio]) {
+			(void)sl_ttc2_radio_mutex_give(radio);
+		}
 	}
 
-	sl_ttc2_delay_ms(5);
+	return 0;
+}
 
-	if (sl_ttc2_read_antenna_status(config, &(data->antenna_status)) != 0) {
-		err_counter++;
-	}
+static const uint8_t sl_ttc2_hk_regs[] = {
+	SL_TTC2_REG_TIME_COUNTER,
+	SL_TTC2_REG_RESET_COUNTER,
+	SL_TTC2_REG_LAST_RESET_CAUSE,
+	SL_TTC2_REG_INPUT_VOLTAGE_MCU,
+	SL_TTC2_REG_INPUT_CURRENT_MCU,
+	SL_TTC2_REG_TEMPERATURE_MCU,
+	SL_TTC2_REG_INPUT_VOLTAGE_RADIO,
+	SL_TTC2_REG_INPUT_CURRENT_RADIO,
+	SL_TTC2_REG_TEMPERATURE_RADIO,
+	SL_TTC2_REG_LAST_VALID_TC,
+	SL_TTC2_REG_RSSI_LAST_VALID_TC,
+	SL_TTC2_REG_TEMPERATURE_ANTENNA,
+	SL_TTC2_REG_ANTENNA_STATUS,
+	SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS,
+	SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS,
+	SL_TTC2_REG_TX_PACKET_COUNTER,
+	SL_TTC2_REG_RX_PACKET_COUNTER,
+};
+
+#define SL_TTC2_HK_REGS_COUNT (sizeof(sl_ttc2_hk_regs) / sizeof(sl_ttc2_hk_regs[0]))
 
-	if (sl_ttc2_read_antenna_deployment_status(
-		    config, &(data->deployment_status)) != 0) {
-		err_counter++;
+int sl_ttc2_read_hk_data(sl_ttc2_config_t *config, sl_ttc2_hk_data_t *data)
+{
+	int failed = 0;
+
+	if (sl_ttc2_read_hk_data_multi(&config, data, &failed, 1U) != 0) {
+		return -1;
 	}
 
-	if (sl_ttc2_read_antenna_deployment_hibernation_status(
-		    config, &(data->hibernation_status)) != 0) {
-		err_counter++;
+	return failed;
+}
+
+int sl_ttc2_read_hk_data_multi(sl_ttc2_config_t **config,
+			       sl_ttc2_hk_data_t *data, int *failed, uint8_t n)
+{
+	uint32_t buf[SL_TTC2_RADIOS_MAX][SL_TTC2_HK_REGS_COUNT];
+	sl_ttc2_read_t reads[SL_TTC2_RADIOS_MAX];
+
+	if ((n == 0U) || (n > SL_TTC2_RADIOS_MAX)) {
+		return -1;
 	}
 
-	sl_ttc2_delay_ms(5);
+	(void)memset(buf, 0xFF, sizeof(buf));
+
+	for (uint8_t r = 0U; r < n; r++) {
+		reads[r] = (sl_ttc2_read_t){
+			.config = config[r],
+			.adr = sl_ttc2_hk_regs,
+			.count = (uint8_t)SL_TTC2_HK_REGS_COUNT,
+			.val = buf[r],
+		};
+	}
 
-	/* Packet counter */
-	if (sl_ttc2_read_pkt_counter(config, SL_TTC2_TX_PKT,
-				     &(data->tx_packet_counter)) != 0) {
-		err_counter++;
+	if (sl_ttc2_read_regs_multi(reads, n) != 0) {
+		return -1;
 	}
 
-	if (sl_ttc2_read_pkt_counter(config, SL_TTC2_RX_PKT,
-				     &(data->rx_packet_counter)) != 0) {
-		err_counter++;
+	for (uint8_t r = 0U; r < n; r++) {
+		failed[r] = reads[r].failed;
+
+		data[r].time_counter = buf[r][0];
+		data[r].reset_counter = (uint16_t)buf[r][1];
+		data[r].last_reset_cause = (uint8_t)buf[r][2];
+		data[r].voltage_mcu = (sl_ttc2_voltage_t)buf[r][3];
+		data[r].current_mcu = (sl_ttc2_current_t)buf[r][4];
+		data[r].temperature_mcu = (sl_ttc2_temp_t)buf[r][5];
+		data[r].voltage_radio = (sl_ttc2_voltage_t)buf[r][6];
+		data[r].current_radio = (sl_ttc2_current_t)buf[r][7];
+		data[r].temperature_radio = (sl_ttc2_temp_t)buf[r][8];
+		data[r].last_valid_tc = (uint8_t)buf[r][9];
+		data[r].rssi_last_valid_tc = (sl_ttc2_rssi_t)buf[r][10];
+		data[r].temperature_antenna = (sl_ttc2_temp_t)buf[r][11];
+		data[r].antenna_status = (uint16_t)buf[r][12];
+		data[r].deployment_status = (uint8_t)buf[r][13];
+		data[r].hibernation_status = (uint8_t)buf[r][14];
+		data[r].tx_packet_counter = buf[r][15];
+		data[r].rx_packet_counter = buf[r][16];
 	}
 
-	return err_counter;
+	return 0;
 }
 
 int sl_ttc2_read_device_id(sl_ttc2_config_t *config, uint16_t *val)
@@ -751,7 +733,8 @@ int sl_ttc2_transmit_packet(sl_ttc2_config_t *config, uint8_t *data,
 {
 	int err = -1;
 
-	uint8_t buf[3 + 220] = { 0 };
+	uint8_t buf[8] = { 0 };
+	uint8_t pkt[3 + 220 + 1] = { 0 };
 
 	/* Adding preamble byte */
 	buf[0] = SL_TTC2_PKT_PREAMBLE;
@@ -763,23 +746,30 @@ int sl_ttc2_transmit_packet(sl_ttc2_config_t *config, uint8_t *data,
 	buf[2] = len;
 
 	/* Calculate CRC */
-	buf[7] = crc8_get_val(buf, 7U);
+	buf[7] = checksum_crc8(buf, 7U);
 
-	if (sl_ttc2_mutex_take() == 0) {
-		if (sl_ttc2_spi_write(config, buf, 8U) == 0) {
-			sl_ttc2_delay_ms(SL_TTC2_TRANSACTION_DELAY_MS);
+	/* Payload frame */
+	(void)memcpy(pkt, buf, 3U);
+	(void)memcpy(&pkt[3], data, len);
 
-			(void)memcpy(&buf[3], data, len);
+	/* Calculate CRC */
+	pkt[len + 3U] = checksum_crc8(pkt, len + 3U);
+
+	uint8_t radio = sl_ttc2_radio(config);
 
-			/* Calculate CRC */
-			buf[len + 3U] = crc8_get_val(buf, len + 3U);
+	if (sl_ttc2_radio_mutex_take(radio) == 0) {
+		sl_ttc2_wait_ready(radio);
 
-			err = sl_ttc2_spi_write(config, buf, 3U + len + 1U);
+		if (sl_ttc2_spi_write(config, buf, 8U) == 0) {
+			/* The bus is free for the other radio meanwhile */
+			sl_ttc2_delay_ms(SL_TTC2_TRANSACTION_DELAY_MS);
+
+			err = sl_ttc2_spi_write(config, pkt, 3U + len + 1U);
 		}
 
-		sl_ttc2_delay_ms(SL_TTC2_EXTRA_MUTEX_DELAY_MS);
+		sl_ttc2_set_done(radio);
 
-		(void)sl_ttc2_mutex_give();
+		(void)sl_ttc2_radio_mutex_give(radio);
 	}
 
 	return err;
@@ -798,11 +788,15 @@ int sl_ttc2_read_packet(sl_ttc2_config_t *config, uint8_t *data, uint16_t *len)
 	buf[1] = SL_TTC2_CMD_RECEIVE_PKT;
 
 	/* Calculate CRC */
-	buf[7] = crc8_get_val(buf, 7U);
+	buf[7] = checksum_crc8(buf, 7U);
 
 	if (sl_ttc2_read_len_rx_pkt_in_fifo(config, len) == 0) {
 		if ((*len > 0) && (*len <= 300)) {
-			if (sl_ttc2_mutex_take() == 0) {
+			uint8_t radio = sl_ttc2_radio(config);
+
+			if (sl_ttc2_radio_mutex_take(radio) == 0) {
+				sl_ttc2_wait_ready(radio);
+
 				if (sl_ttc2_spi_write(config, buf, 8U) == 0) {
 					sl_ttc2_delay_ms(
 						SL_TTC2_TRANSACTION_DELAY_MS);
@@ -810,7 +804,7 @@ int sl_ttc2_read_packet(sl_ttc2_config_t *config, uint8_t *data, uint16_t *len)
 					if (sl_ttc2_spi_read(config, data,
 							     1U + 1U + (*len) +
 								     1U) == 0) {
-						if (crc8_get_val(
+						if (checksum_crc8(
 							    data,
 							    1U + 1U + (*len)) ==
 						    data[2U + (*len)]) {
@@ -822,9 +816,9 @@ int sl_ttc2_read_packet(sl_ttc2_config_t *config, uint8_t *data, uint16_t *len)
 					}
 				}
 
-				sl_ttc2_delay_ms(SL_TTC2_EXTRA_MUTEX_DELAY_MS);
+				sl_ttc2_set_done(radio);
 
-				(void)sl_ttc2_mutex_give();
+				(void)sl_ttc2_radio_mutex_give(radio);
 			}
 		}
 	}
@@ -38,10 +38,33 @@
 
 #include <drivers/sl_ttc2.h>
 
-static pthread_mutex_t ttc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t ttc_mutex;
+
+static pthread_mutex_t ttc_radio_mutex[SL_TTC2_RADIOS_MAX];
+
+static pthread_once_t ttc_mutex_once = PTHREAD_ONCE_INIT;
+
+/* Recursive, so a whole sequence of transactions can be done under one take */
+static void sl_ttc2_mutex_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&ttc_mutex, &attr);
+
+    for (unsigned int i = 0U; i < SL_TTC2_RADIOS_MAX; i++)
+    {
+        pthread_mutex_init(&ttc_radio_mutex[i], &attr);
+    }
+
+    pthread_mutexattr_destroy(&attr);
+}
 
 int sl_ttc2_mutex_take(void)
 {
+    pthread_once(&ttc_mutex_once, sl_ttc2_mutex_init);
+
     return pthread_mutex_lock(&ttc_mutex);
 }
 
@@ -50,4 +73,26 @@ int sl_ttc2_mutex_give(void)
     return pthread_mutex_unlock(&ttc_mutex);
 }
 
+int sl_ttc2_radio_mutex_take(uint8_t radio)
+{
+    if (radio >= SL_TTC2_RADIOS_MAX)
+    {
+        return -1;
+    }
+
+    pthread_once(&ttc_mutex_once, sl_ttc2_mutex_init);
+
+    return pthread_mutex_lock(&ttc_radio_mutex[radio]);
+}
+
+int sl_ttc2_radio_mutex_give(uint8_t radio)
+{
+    if (radio >= SL_TTC2_RADIOS_MAX)
+    {
+        return -1;
+    }
+
+    return pthread_mutex_unlock(&ttc_radio_mutex[radio]);
+}
+
 /** \} End of sl_ttc2_mutex group */
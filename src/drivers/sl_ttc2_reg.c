@@ -0,0 +1,95 @@
+/*
+ * sl_ttc2_reg.c
+ *
+ * Copyright The OBDH 2.0 Contributors.
+ *
+ * This file is part of OBDH 2.0.
+ *
+ * OBDH 2.0 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OBDH 2.0 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OBDH 2.0. If not, see <http:/\/www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \brief SpaceLab TTC 2.0 driver register codec.
+ *
+ * \author Carlos Augusto Porto Freitas <carlos.portof@hotmail.com>
+ *
+ * \version 0.1.0
+ *
+ * \date 2026/10/17
+ *
+ * \addtogroup sl_ttc2
+ * \{
+ */
+
+#include <drivers/sl_ttc2.h>
+
+/*
+ * Width of the value of each register. The value sits at the start of the
+ * four data bytes of a packet, MSB first. Registers missing here carry four
+ * bytes.
+ */
+static const uint8_t sl_ttc2_reg_width[SL_TTC2_REG_COUNT] = {
+	[SL_TTC2_REG_DEVICE_ID] = 2U,
+	[SL_TTC2_REG_HARDWARE_VERSION] = 1U,
+	[SL_TTC2_REG_FIRMWARE_VERSION] = 4U,
+	[SL_TTC2_REG_TIME_COUNTER] = 4U,
+	[SL_TTC2_REG_RESET_COUNTER] = 2U,
+	[SL_TTC2_REG_LAST_RESET_CAUSE] = 1U,
+	[SL_TTC2_REG_INPUT_VOLTAGE_MCU] = 2U,
+	[SL_TTC2_REG_INPUT_CURRENT_MCU] = 2U,
+	[SL_TTC2_REG_TEMPERATURE_MCU] = 2U,
+	[SL_TTC2_REG_INPUT_VOLTAGE_RADIO] = 2U,
+	[SL_TTC2_REG_INPUT_CURRENT_RADIO] = 2U,
+	[SL_TTC2_REG_TEMPERATURE_RADIO] = 2U,
+	[SL_TTC2_REG_LAST_VALID_TC] = 1U,
+	[SL_TTC2_REG_RSSI_LAST_VALID_TC] = 2U,
+	[SL_TTC2_REG_TEMPERATURE_ANTENNA] = 2U,
+	[SL_TTC2_REG_ANTENNA_STATUS] = 2U,
+	[SL_TTC2_REG_ANTENNA_DEPLOYMENT_STATUS] = 1U,
+	[SL_TTC2_REG_ANTENNA_DEP_HIB_STATUS] = 1U,
+	[SL_TTC2_REG_TX_ENABLE] = 1U,
+	[SL_TTC2_REG_TX_PACKET_COUNTER] = 4U,
+	[SL_TTC2_REG_RX_PACKET_COUNTER] = 4U,
+	[SL_TTC2_REG_FIFO_TX_PACKET] = 1U,
+	[SL_TTC2_REG_FIFO_RX_PACKET] = 1U,
+	[SL_TTC2_REG_LEN_FIRST_RX_PACKET_IN_FIFO] = 2U,
+	[SL_TTC2_REG_RESET_DEVICE] = 1U,
+	[SL_TTC2_REG_CONSEQ_FAILED_PACKETS] = 4U,
+};
+
+uint8_t sl_ttc2_get_reg_width(uint8_t adr)
+{
+	return (adr < SL_TTC2_REG_COUNT) ? sl_ttc2_reg_width[adr] : 4U;
+}
+
+void sl_ttc2_encode_reg(uint8_t adr, uint32_t val, uint8_t *buf)
+{
+	uint32_t raw = val << (8U * (4U - sl_ttc2_get_reg_width(adr)));
+
+	buf[0] = (raw >> 24) & 0xFFU;
+	buf[1] = (raw >> 16) & 0xFFU;
+	buf[2] = (raw >> 8) & 0xFFU;
+	buf[3] = (raw >> 0) & 0xFFU;
+}
+
+uint32_t sl_ttc2_decode_reg(uint8_t adr, const uint8_t *buf)
+{
+	uint32_t raw = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+		       ((uint32_t)buf[2] << 8) | ((uint32_t)buf[3] << 0);
+
+	return raw >> (8U * (4U - sl_ttc2_get_reg_width(adr)));
+}
+
+/** \} End of sl_ttc2 group */
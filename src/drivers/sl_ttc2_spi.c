@@ -36,81 +36,159 @@
 
 #include <drivers/sl_ttc2.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 
-#define CRC8_INITIAL_VAL 0x00U /* CRC8-CCITT initial value. */
-#define CRC8_POLYNOMIAL 0x07U /* CRC8-CCITT polynomial. */
+#include <system/checksum.h>
 
-static uint8_t crc8_get_val(uint8_t *data, uint8_t len)
+#define SL_TTC2_SPI_DEVS_MAX 2U /* One device per radio. */
+#define SL_TTC2_SPI_MODE SPI_MODE_0
+#define SL_TTC2_SPI_BITS 8U
+#define SL_TTC2_SPI_SPEED_HZ 1000000U
+
+struct sl_ttc2_spi_dev {
+	char path[sizeof(((sl_ttc2_config_t *)0)->port_config)];
+	int fd;
+	pthread_mutex_t lock;
+};
+
+static struct sl_ttc2_spi_dev spi_devs[SL_TTC2_SPI_DEVS_MAX];
+
+static unsigned int spi_devs_len;
+
+static pthread_mutex_t spi_devs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct sl_ttc2_spi_dev *sl_ttc2_spi_get(sl_ttc2_config_t *config)
 {
-	uint8_t crc = CRC8_INITIAL_VAL;
-	uint8_t i = 0U;
-	uint8_t j = 0U;
+	struct sl_ttc2_spi_dev *dev = NULL;
 
-	for (i = 0U; i < len; i++) {
-		crc ^= data[i];
+	pthread_mutex_lock(&spi_devs_lock);
 
-		j = 0U;
-		for (j = 0U; j < 8U; j++) {
-			crc = (crc << 1) ^
-			      ((crc & 0x80U) ? CRC8_POLYNOMIAL : 0U);
+	for (unsigned int i = 0U; i < spi_devs_len; ++i) {
+		if (strncmp(spi_devs[i].path, config->port_config,
+			    sizeof(spi_devs[i].path)) == 0) {
+			dev = &spi_devs[i];
+			break;
 		}
+	}
 
-		crc &= 0xFFU;
+	if ((dev == NULL) && (spi_devs_len < SL_TTC2_SPI_DEVS_MAX)) {
+		dev = &spi_devs[spi_devs_len++];
+
+		strncpy(dev->path, config->port_config, sizeof(dev->path));
+		dev->fd = -1;
+		pthread_mutex_init(&dev->lock, NULL);
 	}
 
-	return crc;
-}
+	pthread_mutex_unlock(&spi_devs_lock);
 
-int sl_ttc2_spi_init(sl_ttc2_config_t *config)
-{
-	return 0;
+	return dev;
 }
 
-int sl_ttc2_spi_write(sl_ttc2_config_t *config, uint8_t *data, uint16_t len)
+static void sl_ttc2_spi_close(struct sl_ttc2_spi_dev *dev)
 {
-	uint8_t rbuf[230] = { 0 };
+	if (dev->fd >= 0) {
+		close(dev->fd);
+	}
 
-	return sl_ttc2_spi_transfer(config, data, rbuf, len);
+	dev->fd = -1;
 }
 
-int sl_ttc2_spi_transfer(sl_ttc2_config_t *config, uint8_t *wdata,
-			 uint8_t *rdata, uint16_t len)
+static int sl_ttc2_spi_open(struct sl_ttc2_spi_dev *dev)
 {
-	int ret = 0;
+	uint8_t mode = SL_TTC2_SPI_MODE;
+	uint8_t bits = SL_TTC2_SPI_BITS;
+	uint32_t speed = SL_TTC2_SPI_SPEED_HZ;
 
-	int fd = open(config->port_config, O_RDWR);
+	if (dev->fd >= 0) {
+		return 0;
+	}
+
+	dev->fd = open(dev->path, O_RDWR | O_CLOEXEC);
 
-	if (fd < 0) {
+	if (dev->fd < 0) {
 		perror("sl_ttc2: open SPI devices");
 		return -1;
 	}
 
-	int mode = SPI_MODE_0;
+	if ((ioctl(dev->fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+	    (ioctl(dev->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+	    (ioctl(dev->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)) {
+		perror("sl_ttc2: configure SPI device");
+		sl_ttc2_spi_close(dev);
+		return -1;
+	}
+
+	return 0;
+}
 
-	ioctl(fd, SPI_IOC_WR_MODE, &mode);
+int sl_ttc2_spi_init(sl_ttc2_config_t *config)
+{
+	int err = -1;
 
+	struct sl_ttc2_spi_dev *dev = sl_ttc2_spi_get(config);
+
+	if (dev != NULL) {
+		pthread_mutex_lock(&dev->lock);
+
+		err = sl_ttc2_spi_open(dev);
+
+		pthread_mutex_unlock(&dev->lock);
+	}
+
+	return err;
+}
+
+int sl_ttc2_spi_write(sl_ttc2_config_t *config, uint8_t *data, uint16_t len)
+{
+	return sl_ttc2_spi_transfer(config, data, NULL, len);
+}
+
+int sl_ttc2_spi_transfer(sl_ttc2_config_t *config, uint8_t *wdata,
+			 uint8_t *rdata, uint16_t len)
+{
 	struct spi_ioc_transfer tr = {
 		.tx_buf = (unsigned long)wdata,
 		.rx_buf = (unsigned long)rdata,
 		.len = len,
-		.delay_usecs = 0,
-		.speed_hz = 1000000,
-		.bits_per_word = 8,
+		.speed_hz = SL_TTC2_SPI_SPEED_HZ,
+		.bits_per_word = SL_TTC2_SPI_BITS,
 	};
+	int err = -1;
+
+	struct sl_ttc2_spi_dev *dev = sl_ttc2_spi_get(config);
+
+	if (dev == NULL) {
+		return -1;
+	}
 
-	ret = ioctl(fd, SPI_IOC_MESSAGE(1), &tr);
+	pthread_mutex_lock(&dev->lock);
 
-	if (ret < 0) {
-		perror("sl_ttc: SPI tranfer!");
+	if (sl_ttc2_spi_open(dev) == 0) {
+		/* Both radios share the controller, only while clocking */
+		(void)sl_ttc2_mutex_take();
+
+		int ret = ioctl(dev->fd, SPI_IOC_MESSAGE(1), &tr);
+
+		(void)sl_ttc2_mutex_give();
+
+		if (ret < 0) {
+			perror("sl_ttc: SPI tranfer!");
+
+			/* Reopened by the next transfer */
+			sl_ttc2_spi_close(dev);
+		} else {
+			err = 0;
+		}
 	}
 
-	close(fd);
+	pthread_mutex_unlock(&dev->lock);
 
-	return ret;
+	return err;
 }
 
 int sl_ttc2_spi_read(sl_ttc2_config_t *config, uint8_t *data, uint16_t len)
@@ -121,7 +199,7 @@ int sl_ttc2_spi_read(sl_ttc2_config_t *config, uint8_t *data, uint16_t len)
 	wbuf[0] = 0x7EU;
 
 	/* Adding CRC */
-	wbuf[len - 1U] = crc8_get_val(wbuf, len - 1U);
+	wbuf[len - 1U] = checksum_crc8(wbuf, len - 1U);
 
 	return sl_ttc2_spi_transfer(config, wbuf, data, len);
 }
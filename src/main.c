@@ -1,41 +1,145 @@
 #include <pthread.h>
-#include <stdint.h>
+#include <signal.h>
 
 #include <stdlib.h>
+#include <drivers/dev_timing.h>
+#include <system/blackboard.h>
 #include <system/sys_log.h>
 #include <system/context.h>
+#include <system/cmd_server.h>
+#include <system/evloop.h>
+#include <system/task_stats.h>
+#include <system/tm_archive.h>
+#include <system/tm_pub.h>
+#include <system/tm_shm.h>
 
-extern void *pos_det_thread(void *arg);
-extern void *read_ttc_thread(void *arg);
-extern void *read_eps_thread(void *arg);
-extern void *read_edc_thread(void *arg);
-extern void *control_heater_thread(void *arg);
+extern struct evloop_task pos_det_task;
+extern struct evloop_task read_ttc_task;
+extern struct evloop_task read_eps_task;
+extern struct evloop_task read_edc_task;
+extern struct evloop_task control_heater_task;
 
 int main(void)
 {
+	sigset_t signals;
+
+	/* Signals are handled synchronously below, block them in every thread */
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGHUP);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+#ifdef OBDH2_SIM_BINARY_LOG
+	sys_log_set_log_file("/var/local/obdh-sim.blog");
+	sys_log_set_format(SYS_LOG_FORMAT_BINARY);
+#else
 	sys_log_set_log_file("/var/local/obdh-sim.log");
+#endif
 
-	struct obdh_sim_ctx ctx = { 0 };
-	ctx.tids = calloc(5U, sizeof(pthread_t));
+	if (sys_log_start_recorder("/var/local/obdh-sim.rec", 4096U) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, "ctx",
+			"Failed to start the flight recorder!");
+	}
 
-	if (pthread_mutex_init(&ctx.lock, NULL) < 0) {
+	if (sys_log_start_async() != 0) {
 		sys_log_print_event_from_module(
-			SYS_LOG_ERROR, "ctx",
-			"Failed to initialize mutex! Exiting...");
-		exit(1);
+			SYS_LOG_WARNING, "ctx",
+			"Failed to start async logging, using direct writes!");
 	}
 
-	pthread_create(&ctx.tids[0], NULL, pos_det_thread, (void *)&ctx);
-	pthread_create(&ctx.tids[1], NULL, read_ttc_thread, (void *)&ctx);
-	pthread_create(&ctx.tids[2], NULL, read_eps_thread, (void *)&ctx);
-	pthread_create(&ctx.tids[3], NULL, read_edc_thread, (void *)&ctx);
-	pthread_create(&ctx.tids[4], NULL, control_heater_thread, (void *)&ctx);
+	if (tm_pub_init(OBDH2_SIM_TM_ENDPOINT) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, "ctx",
+			"Failed to start the telemetry publisher!");
+	}
+
+	if (tm_shm_init(TM_SHM_NAME) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, "ctx",
+			"Failed to create the telemetry shared memory!");
+	}
 
-	for (uint8_t i = 0U; i < 5U; ++i) {
-		pthread_join(ctx.tids[i], NULL);
+	if (tm_archive_open("/var/local/obdh-sim-tm") != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, "ctx",
+			"Failed to open the telemetry archive!");
 	}
 
+	/* Missing on the first run, the latencies are learnt from scratch */
+	(void)dev_timing_load("/var/local/obdh-sim.timing");
+
+	struct obdh_sim_ctx ctx = { 0 };
+	ctx.tids = calloc(6U, sizeof(pthread_t));
+
+	/* The heaters follow the eclipse as soon as it changes */
+	(void)blackboard_subscribe(BLACKBOARD_ECLIPSE, &control_heater_task);
+
+	struct evloop_task *tasks[] = {
+		&pos_det_task,	&read_ttc_task,	      &read_eps_task,
+		&read_edc_task, &control_heater_task,
+	};
+
+	for (size_t i = 0U; i < (sizeof(tasks) / sizeof(tasks[0])); ++i) {
+		tasks[i]->arg = &ctx;
+
+#ifdef OBDH2_SIM_EVENT_LOOP
+		evloop_add(tasks[i]);
+#else
+		pthread_create(&ctx.tids[i], NULL, evloop_task_thread,
+			       tasks[i]);
+#endif
+	}
+
+#ifdef OBDH2_SIM_EVENT_LOOP
+	pthread_create(&ctx.tids[0], NULL, evloop_thread, NULL);
+#endif
+
+	pthread_create(&ctx.tids[5], NULL, cmd_server_thread, NULL);
+
+	int sig = 0;
+
+	for (;;) {
+		if (sigwait(&signals, &sig) != 0)
+			continue;
+
+		if (sig == SIGUSR1) {
+			task_stats_dump();
+			continue;
+		}
+
+		if (sig != SIGHUP)
+			break;
+
+		tm_archive_sync();
+
+		if (sys_log_reopen() != 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, "ctx", "Failed to reopen log file!");
+		}
+	}
+
+	sys_log_print_event_from_module(SYS_LOG_INFO, "ctx",
+					"Exiting on signal %d...", sig);
+
+#ifdef OBDH2_SIM_EVENT_LOOP
+	evloop_stop();
+	pthread_join(ctx.tids[0], NULL);
+#endif
+
+	if (dev_timing_save("/var/local/obdh-sim.timing") != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, "ctx",
+			"Failed to save the device timings!");
+	}
+
+	tm_archive_close();
+
 	free(ctx.tids);
 
+	sys_log_stop_async();
+
 	return 0;
 }
@@ -0,0 +1,151 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <system/blackboard.h>
+#include <system/seqlock.h>
+
+static atomic_bool blackboard_eclipsed;
+
+static struct {
+	uint32_t seq;
+	bool valid;
+	tm_pub_orbit_t orbit;
+} blackboard_orbit;
+
+static struct {
+	uint32_t seq;
+	bool valid;
+	struct blackboard_battery battery;
+} blackboard_battery;
+
+static atomic_int blackboard_health[BLACKBOARD_DEV_COUNT];
+
+static struct evloop_task *blackboard_subscribers[BLACKBOARD_KEY_COUNT]
+						 [BLACKBOARD_SUBSCRIBERS_MAX];
+
+static unsigned int blackboard_nsubscribers[BLACKBOARD_KEY_COUNT];
+
+/* Of the subscriptions only, the entries are lock-free */
+static pthread_mutex_t blackboard_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void blackboard_notify(enum blackboard_key key)
+{
+	pthread_mutex_lock(&blackboard_lock);
+
+	for (unsigned int i = 0U; i < blackboard_nsubscribers[key]; ++i)
+		evloop_trigger(blackboard_subscribers[key][i]);
+
+	pthread_mutex_unlock(&blackboard_lock);
+}
+
+int blackboard_subscribe(enum blackboard_key key, struct evloop_task *task)
+{
+	int err = -1;
+
+	if (key >= BLACKBOARD_KEY_COUNT)
+		return -1;
+
+	pthread_mutex_lock(&blackboard_lock);
+
+	if (blackboard_nsubscribers[key] < BLACKBOARD_SUBSCRIBERS_MAX) {
+		blackboard_subscribers[key][blackboard_nsubscribers[key]++] =
+			task;
+		err = 0;
+	}
+
+	pthread_mutex_unlock(&blackboard_lock);
+
+	return err;
+}
+
+void blackboard_set_eclipsed(bool eclipsed)
+{
+	if (atomic_exchange_explicit(&blackboard_eclipsed, eclipsed,
+				     memory_order_acq_rel) != eclipsed)
+		blackboard_notify(BLACKBOARD_ECLIPSE);
+}
+
+bool blackboard_get_eclipsed(void)
+{
+	return atomic_load_explicit(&blackboard_eclipsed, memory_order_acquire);
+}
+
+void blackboard_set_orbit(const tm_pub_orbit_t *orbit)
+{
+	seqlock_write_begin(&blackboard_orbit.seq);
+
+	blackboard_orbit.orbit = *orbit;
+	blackboard_orbit.valid = true;
+
+	seqlock_write_end(&blackboard_orbit.seq);
+
+	blackboard_notify(BLACKBOARD_ORBIT);
+}
+
+bool blackboard_get_orbit(tm_pub_orbit_t *orbit)
+{
+	uint32_t start;
+	bool valid;
+
+	do {
+		start = seqlock_read_begin(&blackboard_orbit.seq);
+		valid = blackboard_orbit.valid;
+		*orbit = blackboard_orbit.orbit;
+	} while (seqlock_read_retry(&blackboard_orbit.seq, start));
+
+	return valid;
+}
+
+void blackboard_set_battery(const struct blackboard_battery *battery)
+{
+	/* Only this writer changes the entry, it can be read as is */
+	if (blackboard_battery.valid &&
+	    (memcmp(&blackboard_battery.battery, battery, sizeof(*battery)) ==
+	     0))
+		return;
+
+	seqlock_write_begin(&blackboard_battery.seq);
+
+	blackboard_battery.battery = *battery;
+	blackboard_battery.valid = true;
+
+	seqlock_write_end(&blackboard_battery.seq);
+
+	blackboard_notify(BLACKBOARD_BATTERY);
+}
+
+bool blackboard_get_battery(struct blackboard_battery *battery)
+{
+	uint32_t start;
+	bool valid;
+
+	do {
+		start = seqlock_read_begin(&blackboard_battery.seq);
+		valid = blackboard_battery.valid;
+		*battery = blackboard_battery.battery;
+	} while (seqlock_read_retry(&blackboard_battery.seq, start));
+
+	return valid;
+}
+
+void blackboard_set_health(enum blackboard_dev dev,
+			   enum dev_health_state state)
+{
+	if (dev >= BLACKBOARD_DEV_COUNT)
+		return;
+
+	if (atomic_exchange_explicit(&blackboard_health[dev], (int)state,
+				     memory_order_acq_rel) != (int)state)
+		blackboard_notify(BLACKBOARD_HEALTH);
+}
+
+enum dev_health_state blackboard_get_health(enum blackboard_dev dev)
+{
+	if (dev >= BLACKBOARD_DEV_COUNT)
+		return DEV_HEALTH_UNKNOWN;
+
+	return (enum dev_health_state)atomic_load_explicit(
+		&blackboard_health[dev], memory_order_acquire);
+}
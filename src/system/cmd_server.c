@@ -0,0 +1,430 @@
+#include <endian.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <zmq.h>
+
+#include <libmop/payload.h>
+#include <libmop/pl_list.h>
+#include <devices/eps.h>
+#include <devices/payload.h>
+#include <devices/ttc.h>
+#include <system/cmd_server.h>
+#include <system/ptt_queue.h>
+#include <system/sys_log.h>
+#include <system/tm_pub.h>
+#include <system/tm_store.h>
+
+#define CMD_SERVER_MODULE_NAME "cmd_server"
+
+/* Routing id plus the empty delimiter of REQ clients */
+#define CMD_SERVER_ENVELOPE_MAX 4U
+
+#define CMD_SERVER_REQ_MAX             \
+	(sizeof(struct cmd_server_req_hdr) + \
+	 (CMD_SERVER_ITEMS_MAX * sizeof(struct cmd_server_item)))
+
+#define CMD_SERVER_REP_MAX             \
+	(sizeof(struct cmd_server_rep_hdr) + \
+	 (CMD_SERVER_ITEMS_MAX * sizeof(struct cmd_server_result)))
+
+#define CMD_SERVER_QUERY_REP_MAX       \
+	(sizeof(struct cmd_server_rep_hdr) + \
+	 (CMD_SERVER_QUERY_ENTRIES_MAX * sizeof(struct cmd_server_sample)))
+
+#define CMD_SERVER_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define CMD_SERVER_PTT_REP_MAX         \
+	(sizeof(struct cmd_server_rep_hdr) + \
+	 (PTT_QUEUE_CAPACITY * sizeof(edc_ptt_t)))
+
+#define CMD_SERVER_LOCK_EPS (1U << CMD_SERVER_DEV_EPS)
+#define CMD_SERVER_LOCK_TTC (1U << CMD_SERVER_DEV_TTC)
+#define CMD_SERVER_LOCK_EDC (1U << CMD_SERVER_DEV_EDC)
+
+static int32_t cmd_server_eps(const struct cmd_server_item *item,
+			      uint32_t *value)
+{
+	switch (item->op) {
+	case CMD_SERVER_OP_READ:
+		return eps_get_param(item->adr, value);
+	case CMD_SERVER_OP_WRITE:
+		return eps_set_param(item->adr, le32toh(item->value));
+	default:
+		return CMD_SERVER_ERR_INVALID;
+	}
+}
+
+static int32_t cmd_server_ttc(const struct cmd_server_item *item,
+			      uint32_t *value)
+{
+	if (item->instance > TTC_1)
+		return CMD_SERVER_ERR_INVALID;
+
+	switch (item->op) {
+	case CMD_SERVER_OP_READ:
+		return ttc_get_param(item->instance, item->adr, value);
+	case CMD_SERVER_OP_WRITE:
+		return ttc_set_param(item->instance, item->adr,
+				     le32toh(item->value));
+	default:
+		return CMD_SERVER_ERR_INVALID;
+	}
+}
+
+static int32_t cmd_server_edc(const struct cmd_server_item *item)
+{
+	struct payload *pl = pl_list_get_by_id(item->instance);
+	uint32_t v = le32toh(item->value);
+
+	/* The payload drivers take the argument MSB first */
+	uint8_t args[4] = { (uint8_t)(v >> 24), (uint8_t)(v >> 16),
+			    (uint8_t)(v >> 8), (uint8_t)v };
+
+	if ((pl == NULL) || (item->op != CMD_SERVER_OP_EXEC))
+		return CMD_SERVER_ERR_INVALID;
+
+	return payload_write_cmd(pl, item->adr, args, sizeof(args));
+}
+
+static void cmd_server_exec(const struct cmd_server_item *item,
+			    struct cmd_server_result *res)
+{
+	uint32_t value = 0U;
+	int32_t err = CMD_SERVER_ERR_INVALID;
+
+	switch (item->dev) {
+	case CMD_SERVER_DEV_EPS:
+		err = cmd_server_eps(item, &value);
+		break;
+	case CMD_SERVER_DEV_TTC:
+		err = cmd_server_ttc(item, &value);
+		break;
+	case CMD_SERVER_DEV_EDC:
+		err = cmd_server_edc(item);
+		break;
+	default:
+		break;
+	}
+
+	if ((err != CMD_SERVER_OK) && (err != CMD_SERVER_ERR_INVALID))
+		err = CMD_SERVER_ERR_DEVICE;
+
+	res->status = (int32_t)htole32((uint32_t)err);
+	res->value = (err == CMD_SERVER_OK) ? htole32(value) : 0U;
+}
+
+/*
+ * Runs a batch holding every device lock it needs, always taken in the
+ * EPS, TTC, EDC order so batches can't deadlock with each other.
+ */
+static void cmd_server_run(const struct cmd_server_item *items, uint8_t count,
+			   struct cmd_server_result *res)
+{
+	unsigned int locks = 0U;
+
+	for (uint8_t i = 0U; i < count; ++i) {
+		if (items[i].dev <= CMD_SERVER_DEV_EDC)
+			locks |= 1U << items[i].dev;
+	}
+
+	if (locks & CMD_SERVER_LOCK_EPS)
+		eps_lock();
+
+	if (locks & CMD_SERVER_LOCK_TTC)
+		ttc_lock();
+
+	if (locks & CMD_SERVER_LOCK_EDC)
+		payload_edc_lock();
+
+	for (uint8_t i = 0U; i < count; ++i)
+		cmd_server_exec(&items[i], &res[i]);
+
+	if (locks & CMD_SERVER_LOCK_EDC)
+		payload_edc_unlock();
+
+	if (locks & CMD_SERVER_LOCK_TTC)
+		ttc_unlock();
+
+	if (locks & CMD_SERVER_LOCK_EPS)
+		eps_unlock();
+}
+
+static int32_t cmd_server_log_level(const struct cmd_server_query *query)
+{
+	if (query->name[CMD_SERVER_QUERY_NAME_MAX - 1U] != '\0')
+		return CMD_SERVER_ERR_INVALID;
+
+	if (sys_log_set_level((query->name[0] != '\0') ? query->name : NULL,
+			      query->arg) != 0)
+		return CMD_SERVER_ERR_INVALID;
+
+	return CMD_SERVER_OK;
+}
+
+static int cmd_server_tm_field(const struct cmd_server_query *query)
+{
+	if (query->name[CMD_SERVER_QUERY_NAME_MAX - 1U] != '\0')
+		return -1;
+
+	return tm_store_field((enum tm_pub_type)query->arg, query->name);
+}
+
+static int32_t cmd_server_tm_scan(const struct cmd_server_query *query,
+				  uint8_t *entries, uint8_t *count)
+{
+	uint64_t number[CMD_SERVER_QUERY_ENTRIES_MAX];
+	uint64_t timestamp[CMD_SERVER_QUERY_ENTRIES_MAX];
+	int64_t val[CMD_SERVER_QUERY_ENTRIES_MAX];
+	long n = tm_store_scan((enum tm_pub_type)query->arg, query->instance,
+			       cmd_server_tm_field(query),
+			       le64toh(query->from), le64toh(query->to),
+			       le64toh(query->from_number), number, timestamp,
+			       val, CMD_SERVER_QUERY_ENTRIES_MAX);
+
+	if (n < 0)
+		return CMD_SERVER_ERR_INVALID;
+
+	for (long i = 0; i < n; ++i) {
+		struct cmd_server_sample sample = {
+			.number = htole64(number[i]),
+			.timestamp = htole64(timestamp[i]),
+			.value = (int64_t)htole64((uint64_t)val[i]),
+		};
+
+		memcpy(&entries[(size_t)i * sizeof(sample)], &sample,
+		       sizeof(sample));
+	}
+
+	*count = (uint8_t)n;
+
+	return CMD_SERVER_OK;
+}
+
+static int32_t cmd_server_tm_agg(const struct cmd_server_query *query,
+				 uint8_t *entries, uint8_t *count)
+{
+	struct tm_store_agg agg;
+	struct cmd_server_agg rep = { 0 };
+	uint64_t mean;
+
+	if (tm_store_aggregate((enum tm_pub_type)query->arg, query->instance,
+			       cmd_server_tm_field(query),
+			       le64toh(query->from), le64toh(query->to),
+			       &agg) != 0)
+		return CMD_SERVER_ERR_INVALID;
+
+	memcpy(&mean, &agg.mean, sizeof(mean));
+
+	rep.count = htole32((uint32_t)agg.count);
+	rep.min = (int64_t)htole64((uint64_t)agg.min);
+	rep.max = (int64_t)htole64((uint64_t)agg.max);
+	rep.mean = htole64(mean);
+
+	memcpy(entries, &rep, sizeof(rep));
+	*count = 1U;
+
+	return CMD_SERVER_OK;
+}
+
+static int32_t cmd_server_ptt_pop(const struct cmd_server_query *query,
+				  uint8_t *entries, uint8_t *count)
+{
+	edc_ptt_t ptt[PTT_QUEUE_CAPACITY];
+	size_t max = ((query->arg == 0U) || (query->arg > PTT_QUEUE_CAPACITY)) ?
+			     PTT_QUEUE_CAPACITY :
+			     query->arg;
+	size_t n = ptt_queue_pop(ptt, max);
+
+	memcpy(entries, ptt, n * sizeof(ptt[0]));
+	*count = (uint8_t)n;
+
+	return CMD_SERVER_OK;
+}
+
+/* Runs a single query instead of a batch */
+static size_t cmd_server_query(const uint8_t *req, size_t req_len,
+			       uint8_t *rep)
+{
+	struct cmd_server_query query;
+	struct cmd_server_rep_hdr rep_hdr = {
+		.version = CMD_SERVER_QUERY_VERSION,
+	};
+	uint8_t *entries = &rep[sizeof(rep_hdr)];
+	size_t entry_size = 0U;
+	int32_t err = CMD_SERVER_ERR_INVALID;
+
+	if (req_len == sizeof(query)) {
+		memcpy(&query, req, sizeof(query));
+		rep_hdr.seq = query.seq;
+
+		switch (query.op) {
+		case CMD_SERVER_QUERY_LOG_LEVEL:
+			err = cmd_server_log_level(&query);
+			break;
+		case CMD_SERVER_QUERY_TM_SCAN:
+			err = cmd_server_tm_scan(&query, entries,
+						 &rep_hdr.count);
+			entry_size = sizeof(struct cmd_server_sample);
+			break;
+		case CMD_SERVER_QUERY_TM_AGG:
+			err = cmd_server_tm_agg(&query, entries,
+						&rep_hdr.count);
+			entry_size = sizeof(struct cmd_server_agg);
+			break;
+		case CMD_SERVER_QUERY_PTT_POP:
+			err = cmd_server_ptt_pop(&query, entries,
+						 &rep_hdr.count);
+			entry_size = sizeof(edc_ptt_t);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (err != CMD_SERVER_OK)
+		rep_hdr.count = 0U;
+
+	rep_hdr.status = (int32_t)htole32((uint32_t)err);
+
+	memcpy(rep, &rep_hdr, sizeof(rep_hdr));
+
+	return sizeof(rep_hdr) + (rep_hdr.count * entry_size);
+}
+
+static size_t cmd_server_handle(const uint8_t *req, size_t req_len,
+				uint8_t *rep)
+{
+	struct cmd_server_req_hdr hdr;
+	struct cmd_server_item items[CMD_SERVER_ITEMS_MAX];
+	struct cmd_server_result res[CMD_SERVER_ITEMS_MAX];
+	struct cmd_server_rep_hdr rep_hdr = {
+		.version = CMD_SERVER_VERSION,
+		.status = (int32_t)htole32((uint32_t)CMD_SERVER_ERR_INVALID),
+	};
+
+	if ((req_len > 0U) && (req[0] == CMD_SERVER_QUERY_VERSION))
+		return cmd_server_query(req, req_len, rep);
+
+	if (req_len >= sizeof(hdr)) {
+		memcpy(&hdr, req, sizeof(hdr));
+		rep_hdr.seq = hdr.seq;
+	}
+
+	if ((req_len < sizeof(hdr)) || (hdr.version != CMD_SERVER_VERSION) ||
+	    (hdr.count > CMD_SERVER_ITEMS_MAX) ||
+	    (req_len != sizeof(hdr) + (hdr.count * sizeof(items[0])))) {
+		memcpy(rep, &rep_hdr, sizeof(rep_hdr));
+		return sizeof(rep_hdr);
+	}
+
+	memcpy(items, &req[sizeof(hdr)], hdr.count * sizeof(items[0]));
+
+	cmd_server_run(items, hdr.count, res);
+
+	rep_hdr.count = hdr.count;
+	rep_hdr.status = CMD_SERVER_OK;
+
+	memcpy(rep, &rep_hdr, sizeof(rep_hdr));
+	memcpy(&rep[sizeof(rep_hdr)], res, hdr.count * sizeof(res[0]));
+
+	return sizeof(rep_hdr) + (hdr.count * sizeof(res[0]));
+}
+
+void *cmd_server_thread(void *arg)
+{
+	(void)arg;
+
+	void *ctx = tm_pub_get_context();
+	void *own_ctx = NULL;
+	int linger = 0;
+
+	/* The telemetry publisher failed, run on a context of our own */
+	if (ctx == NULL)
+		ctx = own_ctx = zmq_ctx_new();
+
+	void *sock = (ctx != NULL) ? zmq_socket(ctx, ZMQ_ROUTER) : NULL;
+
+	if ((sock == NULL) ||
+	    (zmq_setsockopt(sock, ZMQ_LINGER, &linger, sizeof(linger)) != 0) ||
+	    (zmq_bind(sock, OBDH2_SIM_CMD_ENDPOINT) != 0)) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						CMD_SERVER_MODULE_NAME,
+						"Failed to bind %s: %s",
+						OBDH2_SIM_CMD_ENDPOINT,
+						zmq_strerror(zmq_errno()));
+
+		if (sock != NULL)
+			zmq_close(sock);
+
+		if (own_ctx != NULL)
+			zmq_ctx_term(own_ctx);
+
+		return NULL;
+	}
+
+	sys_log_print_event_from_module(SYS_LOG_INFO, CMD_SERVER_MODULE_NAME,
+					"Serving commands on %s",
+					OBDH2_SIM_CMD_ENDPOINT);
+
+	zmq_msg_t envelope[CMD_SERVER_ENVELOPE_MAX];
+	static uint8_t req[CMD_SERVER_REQ_MAX];
+	static uint8_t rep[CMD_SERVER_MAX(CMD_SERVER_REP_MAX,
+					  CMD_SERVER_MAX(CMD_SERVER_QUERY_REP_MAX,
+							 CMD_SERVER_PTT_REP_MAX))];
+
+	for (;;) {
+		size_t frames = 0U;
+		size_t req_len = 0U;
+		bool valid = true;
+		zmq_msg_t msg;
+
+		/* Everything before the last frame is the envelope */
+		for (;;) {
+			zmq_msg_init(&msg);
+
+			if (zmq_msg_recv(&msg, sock, 0) < 0) {
+				valid = false;
+				break;
+			}
+
+			if (!zmq_msg_more(&msg))
+				break;
+
+			if (frames < CMD_SERVER_ENVELOPE_MAX) {
+				zmq_msg_init(&envelope[frames]);
+				zmq_msg_move(&envelope[frames++], &msg);
+			} else {
+				valid = false;
+			}
+
+			zmq_msg_close(&msg);
+		}
+
+		if (valid) {
+			req_len = zmq_msg_size(&msg);
+
+			if (req_len <= sizeof(req))
+				memcpy(req, zmq_msg_data(&msg), req_len);
+			else
+				req_len = 0U;
+		}
+
+		zmq_msg_close(&msg);
+
+		if (valid && (frames > 0U)) {
+			size_t rep_len = cmd_server_handle(req, req_len, rep);
+
+			for (size_t i = 0U; i < frames; ++i)
+				zmq_msg_send(&envelope[i], sock, ZMQ_SNDMORE);
+
+			zmq_send(sock, rep, rep_len, 0);
+		}
+
+		/* Sent messages are empty, closing them is harmless */
+		for (size_t i = 0U; i < frames; ++i)
+			zmq_msg_close(&envelope[i]);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,100 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <system/dev_health.h>
+#include <system/sys_log.h>
+
+static const char *const dev_health_names[] = {
+	[DEV_HEALTH_UNKNOWN] = "unknown",
+	[DEV_HEALTH_READY] = "ready",
+	[DEV_HEALTH_DEGRADED] = "degraded",
+	[DEV_HEALTH_OFFLINE] = "offline",
+};
+
+static uint64_t dev_health_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000U) +
+	       ((uint64_t)ts.tv_nsec / 1000000U);
+}
+
+/* Called with the lock held */
+static void dev_health_set_state(struct dev_health *health,
+				 enum dev_health_state state)
+{
+	if (health->state == state)
+		return;
+
+	sys_log_print_event_from_module(
+		(state == DEV_HEALTH_READY) ? SYS_LOG_INFO : SYS_LOG_WARNING,
+		health->name, "Device %s (was %s)", dev_health_names[state],
+		dev_health_names[health->state]);
+
+	health->state = state;
+
+	if (health->publish != NULL)
+		health->publish(state);
+}
+
+enum dev_health_action dev_health_begin(struct dev_health *health)
+{
+	enum dev_health_action action = DEV_HEALTH_PROBE;
+
+	pthread_mutex_lock(&health->lock);
+
+	switch (health->state) {
+	case DEV_HEALTH_READY:
+		action = DEV_HEALTH_USE;
+		break;
+	case DEV_HEALTH_OFFLINE: {
+		uint64_t now = dev_health_now_ms();
+
+		/*
+		 * Half-open: one probe once the backoff ended. The other
+		 * callers skip the device until the probe is reported, or
+		 * another backoff passed if it never is.
+		 */
+		if (now < health->retry_ms)
+			action = DEV_HEALTH_SKIP;
+		else
+			health->retry_ms = now + health->backoff_ms;
+		break;
+	}
+	default:
+		break;
+	}
+
+	pthread_mutex_unlock(&health->lock);
+
+	return action;
+}
+
+void dev_health_report(struct dev_health *health, bool ok)
+{
+	pthread_mutex_lock(&health->lock);
+
+	if (ok) {
+		health->failures = 0U;
+		health->backoff_ms = 0U;
+		dev_health_set_state(health, DEV_HEALTH_READY);
+	} else if ((health->state == DEV_HEALTH_OFFLINE) ||
+		   (++health->failures >= DEV_HEALTH_FAILURES_MAX)) {
+		health->backoff_ms =
+			(health->backoff_ms == 0U) ?
+				DEV_HEALTH_BACKOFF_MIN_MS :
+				((health->backoff_ms >=
+				  (DEV_HEALTH_BACKOFF_MAX_MS / 2U)) ?
+					 DEV_HEALTH_BACKOFF_MAX_MS :
+					 (health->backoff_ms * 2U));
+		health->retry_ms = dev_health_now_ms() + health->backoff_ms;
+		dev_health_set_state(health, DEV_HEALTH_OFFLINE);
+	} else {
+		dev_health_set_state(health, DEV_HEALTH_DEGRADED);
+	}
+
+	pthread_mutex_unlock(&health->lock);
+}
@@ -0,0 +1,416 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <system/evloop.h>
+#include <system/sys_log.h>
+
+#define EVLOOP_MODULE_NAME "evloop"
+
+#define EVLOOP_NS_PER_MS 1000000ULL
+
+static struct evloop_task *heap[EVLOOP_TASKS_MAX];
+
+static unsigned int heap_len;
+
+static unsigned int heap_seq;
+
+/* Taken by evloop_add() callers, steps run without it */
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t evloop_once = PTHREAD_ONCE_INIT;
+
+static int epoll_fd = -1;
+
+static int timer_fd = -1;
+
+/* Read by evloop_trigger() from any thread, set once the loop fds exist */
+static atomic_int wake_fd = -1;
+
+static atomic_bool evloop_stopping;
+
+/* Set by evloop_trigger(), for the loop to look for triggered tasks */
+static atomic_bool evloop_triggered;
+
+/* Task threads wait for their next release on their own condition */
+static pthread_mutex_t wait_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t evloop_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void evloop_init(void)
+{
+	struct epoll_event ev = { .events = EPOLLIN };
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	int fd = eventfd(0, EFD_CLOEXEC);
+
+	if ((epoll_fd < 0) || (timer_fd < 0) || (fd < 0)) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						EVLOOP_MODULE_NAME,
+						"Failed to create the loop fds!");
+		return;
+	}
+
+	ev.data.fd = timer_fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+
+	ev.data.fd = fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+
+	atomic_store_explicit(&wake_fd, fd, memory_order_release);
+}
+
+static int evloop_wake(void)
+{
+	int fd = atomic_load_explicit(&wake_fd, memory_order_acquire);
+	uint64_t one = 1U;
+
+	if (fd < 0)
+		return -1;
+
+	return (write(fd, &one, sizeof(one)) == sizeof(one)) ? 0 : -1;
+}
+
+/* Clears the timerfd expirations or the wake counter */
+static int evloop_drain(int fd)
+{
+	uint64_t count;
+
+	return (read(fd, &count, sizeof(count)) == sizeof(count)) ? 0 : -1;
+}
+
+/* Steps due within the same millisecond run in priority order */
+static bool evloop_before(const struct evloop_task *a,
+			  const struct evloop_task *b)
+{
+	uint64_t a_due = a->due / EVLOOP_NS_PER_MS;
+	uint64_t b_due = b->due / EVLOOP_NS_PER_MS;
+
+	if (a_due != b_due)
+		return a_due < b_due;
+
+	if (a->prio != b->prio)
+		return a->prio < b->prio;
+
+	return a->seq < b->seq;
+}
+
+static void heap_push(struct evloop_task *task)
+{
+	unsigned int i = heap_len++;
+
+	while (i > 0U) {
+		unsigned int parent = (i - 1U) / 2U;
+
+		if (!evloop_before(task, heap[parent]))
+			break;
+
+		heap[i] = heap[parent];
+		i = parent;
+	}
+
+	heap[i] = task;
+}
+
+static struct evloop_task *heap_pop(void)
+{
+	struct evloop_task *top = heap[0];
+	struct evloop_task *last = heap[--heap_len];
+	unsigned int i = 0U;
+
+	for (;;) {
+		unsigned int child = (2U * i) + 1U;
+
+		if (child >= heap_len)
+			break;
+
+		if (((child + 1U) < heap_len) &&
+		    evloop_before(heap[child + 1U], heap[child]))
+			child++;
+
+		if (!evloop_before(heap[child], last))
+			break;
+
+		heap[i] = heap[child];
+		i = child;
+	}
+
+	if (heap_len > 0U)
+		heap[i] = last;
+
+	return top;
+}
+
+/* Moves the triggered tasks waiting for their next cycle to now */
+static void heap_release_triggered(uint64_t now)
+{
+	struct evloop_task *tasks[EVLOOP_TASKS_MAX];
+	unsigned int len = heap_len;
+
+	for (unsigned int i = 0U; i < len; ++i)
+		tasks[i] = heap[i];
+
+	heap_len = 0U;
+
+	/* Tasks in the middle of a cycle see the trigger when it ends */
+	for (unsigned int i = 0U; i < len; ++i) {
+		if ((tasks[i]->start == 0U) &&
+		    atomic_exchange_explicit(&tasks[i]->triggered, false,
+					     memory_order_acq_rel)) {
+			tasks[i]->release = now;
+			tasks[i]->due = now;
+		}
+
+		heap_push(tasks[i]);
+	}
+}
+
+static int evloop_task_step(struct evloop_task *task)
+{
+	if (task->start == 0U) {
+		task->start = evloop_now();
+		task_stats_record(&task->stats.lateness,
+				  task->start - task->release);
+	}
+
+	return task->step(task);
+}
+
+/*
+ * Ends a cycle: records its stats, checks its deadline and releases the
+ * next one. Releases already missed are skipped rather than run back to
+ * back.
+ */
+static void evloop_task_finish(struct evloop_task *task, uint64_t end)
+{
+	uint64_t period = (uint64_t)task->period_ms * EVLOOP_NS_PER_MS;
+	uint64_t deadline =
+		(uint64_t)((task->deadline_ms != 0U) ? task->deadline_ms :
+						       task->period_ms) *
+		EVLOOP_NS_PER_MS;
+
+	task_stats_record(&task->stats.duration, end - task->start);
+	atomic_fetch_add_explicit(&task->stats.cycles, 1UL,
+				  memory_order_relaxed);
+
+	if ((end - task->release) > deadline) {
+		unsigned long misses = atomic_fetch_add_explicit(
+			&task->stats.overruns, 1UL, memory_order_relaxed);
+
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, EVLOOP_MODULE_NAME,
+			"Task %s missed its deadline by %lu ms (%lu misses)",
+			task->name,
+			(unsigned long)((end - task->release - deadline) /
+					EVLOOP_NS_PER_MS),
+			misses + 1UL);
+	}
+
+	if (atomic_exchange_explicit(&task->triggered, false,
+				    memory_order_acq_rel)) {
+		task->release = end;
+	} else {
+		task->release += period;
+
+		if (task->release <= end)
+			task->release +=
+				(((end - task->release) / period) + 1U) *
+				period;
+	}
+
+	task->due = task->release;
+	task->start = 0U;
+	task->state = 0U;
+	task->iter = 0U;
+}
+
+int evloop_add(struct evloop_task *task)
+{
+	int err = -1;
+
+	pthread_once(&evloop_once, evloop_init);
+
+	if ((task->step == NULL) || (task->period_ms == 0U))
+		return -1;
+
+	pthread_mutex_lock(&heap_lock);
+
+	if (heap_len < EVLOOP_TASKS_MAX) {
+		task->release = evloop_now();
+		task->due = task->release;
+		task->start = 0U;
+		task->state = 0U;
+		task->iter = 0U;
+		task->seq = heap_seq++;
+
+		task_stats_register(&task->stats, task->name);
+
+		heap_push(task);
+		err = 0;
+	}
+
+	pthread_mutex_unlock(&heap_lock);
+
+	if (err == 0)
+		(void)evloop_wake();
+
+	return err;
+}
+
+void *evloop_thread(void *arg)
+{
+	(void)arg;
+
+	pthread_once(&evloop_once, evloop_init);
+
+	if (epoll_fd < 0)
+		return NULL;
+
+	while (!atomic_load_explicit(&evloop_stopping, memory_order_acquire)) {
+		struct evloop_task *task = NULL;
+		struct itimerspec its = { 0 };
+		uint64_t now = evloop_now();
+
+		pthread_mutex_lock(&heap_lock);
+
+		if (atomic_exchange_explicit(&evloop_triggered, false,
+					     memory_order_acq_rel))
+			heap_release_triggered(now);
+
+		if ((heap_len > 0U) && (heap[0]->due <= now))
+			task = heap_pop();
+		else if (heap_len > 0U)
+			its.it_value = (struct timespec){
+				.tv_sec = (time_t)(heap[0]->due / 1000000000ULL),
+				.tv_nsec = (long)(heap[0]->due % 1000000000ULL),
+			};
+
+		pthread_mutex_unlock(&heap_lock);
+
+		if (task == NULL) {
+			struct epoll_event ev;
+
+			/* A zero it_value disarms the timer when the heap is empty */
+			timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+
+			if (epoll_wait(epoll_fd, &ev, 1, -1) > 0)
+				(void)evloop_drain(ev.data.fd);
+
+			continue;
+		}
+
+		int delay = evloop_task_step(task);
+
+		if (delay > EVLOOP_TASK_DONE)
+			task->due = evloop_now() +
+				    ((uint64_t)delay * EVLOOP_NS_PER_MS);
+		else
+			evloop_task_finish(task, evloop_now());
+
+		pthread_mutex_lock(&heap_lock);
+		heap_push(task);
+		pthread_mutex_unlock(&heap_lock);
+	}
+
+	return NULL;
+}
+
+void evloop_stop(void)
+{
+	atomic_store_explicit(&evloop_stopping, true, memory_order_release);
+
+	pthread_once(&evloop_once, evloop_init);
+	(void)evloop_wake();
+}
+
+void evloop_trigger(struct evloop_task *task)
+{
+	atomic_store_explicit(&task->triggered, true, memory_order_release);
+	atomic_store_explicit(&evloop_triggered, true, memory_order_release);
+
+	/* Whichever runtime the task is on, the loop only once it exists */
+	pthread_mutex_lock(&wait_lock);
+
+	if (task->threaded)
+		pthread_cond_signal(&task->wake);
+
+	pthread_mutex_unlock(&wait_lock);
+
+	(void)evloop_wake();
+}
+
+void *evloop_task_thread(void *arg)
+{
+	struct evloop_task *task = arg;
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+	pthread_mutex_lock(&wait_lock);
+
+	pthread_cond_init(&task->wake, &attr);
+	task->threaded = true;
+
+	pthread_mutex_unlock(&wait_lock);
+
+	pthread_condattr_destroy(&attr);
+
+	task->release = evloop_now();
+	task->start = 0U;
+	task->state = 0U;
+	task->iter = 0U;
+
+	task_stats_register(&task->stats, task->name);
+
+	for (;;) {
+		int delay;
+
+		while ((delay = evloop_task_step(task)) > EVLOOP_TASK_DONE) {
+			struct timespec ts = {
+				.tv_sec = delay / 1000,
+				.tv_nsec = (long)(delay % 1000) * 1000000L,
+			};
+
+			clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+		}
+
+		evloop_task_finish(task, evloop_now());
+
+		struct timespec next = {
+			.tv_sec = (time_t)(task->release / 1000000000ULL),
+			.tv_nsec = (long)(task->release % 1000000000ULL),
+		};
+
+		pthread_mutex_lock(&wait_lock);
+
+		while (!atomic_load_explicit(&task->triggered,
+					     memory_order_acquire) &&
+		       (pthread_cond_timedwait(&task->wake, &wait_lock, &next) !=
+			ETIMEDOUT)) {
+		}
+
+		pthread_mutex_unlock(&wait_lock);
+
+		if (atomic_exchange_explicit(&task->triggered, false,
+					     memory_order_acq_rel))
+			task->release = evloop_now();
+	}
+
+	return NULL;
+}
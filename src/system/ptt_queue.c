@@ -0,0 +1,50 @@
+#include <pthread.h>
+#include <stddef.h>
+
+#include <system/ptt_queue.h>
+
+static edc_ptt_t ptt_queue_ring[PTT_QUEUE_CAPACITY];
+
+static size_t ptt_queue_head; /* Oldest packet */
+
+static size_t ptt_queue_len;
+
+static pthread_mutex_t ptt_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int ptt_queue_push(const edc_ptt_t *ptt)
+{
+	int err = 0;
+
+	pthread_mutex_lock(&ptt_queue_lock);
+
+	if (ptt_queue_len == PTT_QUEUE_CAPACITY) {
+		ptt_queue_head = (ptt_queue_head + 1U) % PTT_QUEUE_CAPACITY;
+		--ptt_queue_len;
+		err = -1;
+	}
+
+	ptt_queue_ring[(ptt_queue_head + ptt_queue_len) % PTT_QUEUE_CAPACITY] =
+		*ptt;
+	++ptt_queue_len;
+
+	pthread_mutex_unlock(&ptt_queue_lock);
+
+	return err;
+}
+
+size_t ptt_queue_pop(edc_ptt_t *ptt, size_t max)
+{
+	size_t n = 0U;
+
+	pthread_mutex_lock(&ptt_queue_lock);
+
+	while ((n < max) && (ptt_queue_len > 0U)) {
+		ptt[n++] = ptt_queue_ring[ptt_queue_head];
+		ptt_queue_head = (ptt_queue_head + 1U) % PTT_QUEUE_CAPACITY;
+		--ptt_queue_len;
+	}
+
+	pthread_mutex_unlock(&ptt_queue_lock);
+
+	return n;
+}
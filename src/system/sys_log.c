@@ -1,10 +1,15 @@
+#include <fcntl.h>
 #include <stdarg.h>
-#include <stdbool.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
 #include <system/sys_log.h>
 #include <time.h>
 #include <pthread.h>
+#include <unistd.h>
+
+#include "sys_log_internal.h"
 
 static const char *log_level_strings[] = { "E", "W", "I" };
 
@@ -12,85 +17,448 @@ static const char *log_file = "stdout";
 
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static atomic_int log_format = SYS_LOG_FORMAT_TEXT;
+
+static atomic_int log_fd = -1;
+
+static struct {
+	char module[SYS_LOG_LEVEL_MODULE_MAX];
+	atomic_int level;
+} module_levels[SYS_LOG_LEVEL_MODULES];
+
+static atomic_uint module_level_count;
+
+static atomic_int default_level = SYS_LOG_INFO;
+
+/* Call sites whose level is resolved, updated by sys_log_set_level() */
+static struct sys_log_site *log_sites;
+
+/* Clamps an snprintf() result to the space actually written */
+static size_t sys_log_clamp(int n, size_t size)
+{
+	if (n < 0)
+		return 0U;
+
+	return ((size_t)n < size) ? (size_t)n : (size - 1U);
+}
+
+static size_t sys_log_format_line(char *buf, const struct timespec *ts,
+				  int level, const char *module,
+				  const char *format, va_list args)
+{
+	size_t len = 0U;
+
+	if (module != NULL) {
+		len = sys_log_clamp(snprintf(buf, SYS_LOG_LINE_MAX,
+					     "%lu.%03lu %s %s: ", ts->tv_sec,
+					     ts->tv_nsec / 1000U,
+					     log_level_strings[level], module),
+				    SYS_LOG_LINE_MAX);
+	}
+
+	len += sys_log_clamp(vsnprintf(&buf[len], SYS_LOG_LINE_MAX - len,
+				       format, args),
+			     SYS_LOG_LINE_MAX - len);
+
+	/* Truncated lines still end with a newline */
+	if (len == (SYS_LOG_LINE_MAX - 1U))
+		len--;
+
+	buf[len++] = '\n';
+
+	return len;
+}
+
+static size_t sys_log_encode(char *buf, int mode,
+			     const struct sys_log_bin_site *site,
+			     const struct timespec *ts, int level,
+			     const char *module, const char *format,
+			     va_list args)
+{
+	if (mode == SYS_LOG_FORMAT_TEXT)
+		return sys_log_format_line(buf, ts, level, module, format,
+					   args);
+
+	if (site != NULL)
+		return sys_log_bin_encode_event(buf, site, ts, level, args);
+
+	return sys_log_bin_encode_text(buf, ts, level, module, format, args);
+}
+
+static int sys_log_write(const char *buf, size_t len)
+{
+	int fd = sys_log_file_get();
+
+	if (fd < 0)
+		return -1;
+
+	/* A single write() to an O_APPEND descriptor is never interleaved */
+	if (write(fd, buf, len) < 0)
+		return -1;
+
+	return 0;
+}
+
+static int sys_log_vprint(const struct timespec *ts, int level,
+			  const char *module, const char *format, va_list args)
+{
+	int mode = atomic_load_explicit(&log_format, memory_order_relaxed);
+	const struct sys_log_bin_site *site = NULL;
+
+	/* Interning may emit the FMT record, so it must precede the event */
+	if ((mode == SYS_LOG_FORMAT_BINARY) && (module != NULL))
+		site = sys_log_bin_site_get(module, format);
+
+	if (sys_log_rec_is_running()) {
+		uint64_t rec_idx = 0U;
+		char *rec = sys_log_rec_reserve(&rec_idx);
+		va_list rec_args;
+
+		va_copy(rec_args, args);
+		size_t len = sys_log_encode(rec, mode, site, ts, level, module,
+					    format, rec_args);
+		va_end(rec_args);
+
+		/* The sink reuses the recorded line or record, encoded once */
+		int err = sys_log_emit(rec, len);
+
+		sys_log_rec_commit(rec_idx, len, mode);
+
+		return err;
+	}
+
+	if (sys_log_async_enter()) {
+		void *slot = NULL;
+		char *buf = sys_log_async_reserve(&slot);
+
+		if (buf != NULL)
+			sys_log_async_commit(slot,
+					     sys_log_encode(buf, mode, site, ts,
+							    level, module,
+							    format, args));
+
+		sys_log_async_leave();
+
+		return (buf != NULL) ? 0 : -1;
+	}
+
+	char buf[SYS_LOG_LINE_MAX];
+
+	return sys_log_write(buf, sys_log_encode(buf, mode, site, ts, level,
+						 module, format, args));
+}
+
+int sys_log_emit(const char *buf, size_t len)
+{
+	if (sys_log_async_enter()) {
+		void *slot = NULL;
+		char *line = sys_log_async_reserve(&slot);
+
+		if (line != NULL) {
+			memcpy(line, buf, len);
+			sys_log_async_commit(slot, len);
+		}
+
+		sys_log_async_leave();
+
+		return (line != NULL) ? 0 : -1;
+	}
+
+	return sys_log_write(buf, len);
+}
+
+static int sys_log_file_open(void)
+{
+	int fd;
+
+	if (strcasecmp("stdout", log_file) == 0)
+		fd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+	else
+		fd = open(log_file, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC,
+			  0644);
+
+	if (fd < 0)
+		perror("sys_log: open");
+
+	return fd;
+}
+
+int sys_log_file_get(void)
+{
+	int fd = atomic_load_explicit(&log_fd, memory_order_acquire);
+
+	if (fd >= 0)
+		return fd;
+
+	pthread_mutex_lock(&log_mutex);
+
+	fd = atomic_load_explicit(&log_fd, memory_order_relaxed);
+
+	if (fd < 0) {
+		fd = sys_log_file_open();
+		atomic_store_explicit(&log_fd, fd, memory_order_release);
+	}
+
+	pthread_mutex_unlock(&log_mutex);
+
+	return fd;
+}
+
+int sys_log_reopen(void)
+{
+	int err = 0;
+
+	pthread_mutex_lock(&log_mutex);
+
+	int fd = atomic_load_explicit(&log_fd, memory_order_relaxed);
+
+	if (fd < 0) {
+		/* The first open failed, or the file was never used */
+		fd = sys_log_file_open();
+
+		if (fd < 0)
+			err = -1;
+		else
+			atomic_store_explicit(&log_fd, fd,
+					      memory_order_release);
+	} else {
+		int new_fd = sys_log_file_open();
+
+		/*
+		 * Swap the file behind the descriptor in place, so writers
+		 * never see a closed (or reused) descriptor number.
+		 */
+		if (new_fd < 0) {
+			err = -1;
+		} else {
+			if ((dup2(new_fd, fd) < 0) ||
+			    (fcntl(fd, F_SETFD, FD_CLOEXEC) < 0))
+				err = -1;
+
+			close(new_fd);
+		}
+	}
+
+	pthread_mutex_unlock(&log_mutex);
+
+	/* Producers stop waking the writer once the ring is full */
+	if (err == 0)
+		sys_log_async_wake();
+
+	/* The new file needs its own session and format definitions */
+	if ((err == 0) && (atomic_load_explicit(&log_format,
+						memory_order_relaxed) ==
+			   SYS_LOG_FORMAT_BINARY))
+		sys_log_bin_new_session();
+
+	return err;
+}
+
 int sys_log_set_log_file(const char *filename)
 {
 	log_file = filename;
+
+	return sys_log_reopen();
+}
+
+int sys_log_set_format(int format)
+{
+	if ((format != SYS_LOG_FORMAT_TEXT) && (format != SYS_LOG_FORMAT_BINARY))
+		return -1;
+
+	atomic_store_explicit(&log_format, format, memory_order_relaxed);
+
+	if (format == SYS_LOG_FORMAT_BINARY)
+		sys_log_bin_new_session();
+
 	return 0;
 }
 
-int sys_log_print_event_from_module(int level, const char *module,
-				    const char *format, ...)
+static int sys_log_module_level(const char *module)
 {
-	bool is_stdout = false;
-	struct timespec ts;
-	clock_gettime(CLOCK_REALTIME, &ts);
+	if (module == NULL)
+		return atomic_load_explicit(&default_level,
+					    memory_order_relaxed);
+
+	unsigned int count =
+		atomic_load_explicit(&module_level_count, memory_order_acquire);
+
+	for (unsigned int i = 0U; i < count; ++i) {
+		if (strcmp(module_levels[i].module, module) == 0)
+			return atomic_load_explicit(&module_levels[i].level,
+						    memory_order_relaxed);
+	}
+
+	return atomic_load_explicit(&default_level, memory_order_relaxed);
+}
+
+int sys_log_set_level(const char *module, int level)
+{
+	int err = 0;
+
+	if ((level < SYS_LOG_ERROR) || (level > SYS_LOG_INFO))
+		return -1;
+
+	if ((module != NULL) && (strlen(module) >= SYS_LOG_LEVEL_MODULE_MAX))
+		return -1;
 
 	pthread_mutex_lock(&log_mutex);
 
-	FILE *f = NULL;
+	unsigned int count =
+		atomic_load_explicit(&module_level_count, memory_order_relaxed);
 
-	if (strcasecmp("stdout", log_file) == 0) {
-		f = stdout;
-		is_stdout = true;
+	if (module == NULL) {
+		atomic_store_explicit(&default_level, level,
+				      memory_order_relaxed);
 	} else {
-		f = fopen(log_file, "a");
+		unsigned int i = 0U;
+
+		while ((i < count) &&
+		       (strcmp(module_levels[i].module, module) != 0))
+			i++;
+
+		if (i == SYS_LOG_LEVEL_MODULES) {
+			err = -1;
+		} else {
+			atomic_store_explicit(&module_levels[i].level, level,
+					      memory_order_relaxed);
+
+			if (i == count) {
+				strcpy(module_levels[i].module, module);
+				atomic_store_explicit(&module_level_count,
+						      ++count,
+						      memory_order_release);
+			}
+		}
 	}
 
-	if (!f) {
-		perror("sys_log: fopen");
-		return -1;
+	for (struct sys_log_site *site = log_sites; site != NULL;
+	     site = site->next) {
+		if (!site->mixed)
+			__atomic_store_n(&site->level,
+					 sys_log_module_level(site->module),
+					 __ATOMIC_RELAXED);
 	}
 
-	fprintf(f, "%lu.%03lu %s %s: ", ts.tv_sec, ts.tv_nsec / 1000U,
-		log_level_strings[level], module);
+	pthread_mutex_unlock(&log_mutex);
 
+	return err;
+}
+
+static int sys_log_print_repeated(const struct timespec *ts, int level,
+				  const char *module, const char *format, ...)
+{
 	va_list args;
 	va_start(args, format);
-	vfprintf(f, format, args);
+	int err = sys_log_vprint(ts, level, module, format, args);
 	va_end(args);
 
-	fprintf(f, "\n");
-	fflush(f);
+	return err;
+}
 
-	if (!is_stdout)
-		fclose(f);
+int sys_log_print_suppressed(int level, const char *module,
+			     const char *format, unsigned int count)
+{
+	struct timespec ts;
 
-	pthread_mutex_unlock(&log_mutex);
+	clock_gettime(CLOCK_REALTIME, &ts);
 
-	return 0;
+	return sys_log_print_repeated(&ts, level, module,
+				      "\"%s\" repeated %u times", format,
+				      count);
 }
 
-int sys_log_print_msg(const char *format, ...)
+/* Caches the level of the module of a call site, or gives up if it varies */
+static void sys_log_site_resolve(struct sys_log_site *site, const char *module)
 {
-	bool is_stdout = false;
 	pthread_mutex_lock(&log_mutex);
 
-	FILE *f = NULL;
-
-	if (strcasecmp("stdout", log_file) == 0) {
-		f = stdout;
-		is_stdout = true;
-	} else {
-		f = fopen(log_file, "a");
+	if (!__atomic_load_n(&site->registered, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&site->module, module, __ATOMIC_RELAXED);
+		__atomic_store_n(&site->level, sys_log_module_level(module),
+				 __ATOMIC_RELAXED);
+		site->next = log_sites;
+		log_sites = site;
+		__atomic_store_n(&site->registered, true, __ATOMIC_RELEASE);
+	} else if (!site->mixed && (site->module != module)) {
+		site->mixed = true;
+		__atomic_store_n(&site->module, NULL, __ATOMIC_RELAXED);
+		__atomic_store_n(&site->level, SYS_LOG_SITE_ANY,
+				 __ATOMIC_RELAXED);
 	}
 
-	if (!f) {
-		perror("sys_log: fopen");
-		return -1;
-	}
+	pthread_mutex_unlock(&log_mutex);
+}
+
+static int sys_log_vevent(int level, const char *module, const char *format,
+			  va_list args)
+{
+	struct timespec ts;
+	unsigned int repeated = 0U;
+
+	/* Errors of an absent device would otherwise repeat every cycle */
+	if ((level <= SYS_LOG_WARNING) && (module != NULL) &&
+	    !sys_log_limit_check(level, module, format, &repeated))
+		return 0;
+
+	if (repeated > 0U)
+		sys_log_print_suppressed(level, module, format, repeated);
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return sys_log_vprint(&ts, level, module, format, args);
+}
+
+int (sys_log_print_event_from_module)(int level, const char *module,
+				    const char *format, ...)
+{
+	if ((module != NULL) && (level > sys_log_module_level(module)))
+		return 0;
+
+	va_list args;
+	va_start(args, format);
+	int err = sys_log_vevent(level, module, format, args);
+	va_end(args);
+
+	return err;
+}
+
+int sys_log_print_event_from_site(struct sys_log_site *site, int level,
+				  const char *module, const char *format, ...)
+{
+	const char *site_module =
+		__atomic_load_n(&site->module, __ATOMIC_RELAXED);
+
+	if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE) ||
+	    ((site_module != NULL) && (site_module != module)))
+		sys_log_site_resolve(site, module);
+
+	/* Sites logging for several modules look the level up at each call */
+	int site_level = __atomic_load_n(&site->level, __ATOMIC_RELAXED);
+
+	if (site_level == SYS_LOG_SITE_ANY)
+		site_level = sys_log_module_level(module);
+
+	if (level > site_level)
+		return 0;
 
 	va_list args;
 	va_start(args, format);
-	vfprintf(f, format, args);
+	int err = sys_log_vevent(level, module, format, args);
 	va_end(args);
 
-	fprintf(f, "\n");
-	fflush(f);
+	return err;
+}
 
-	if (!is_stdout)
-		fclose(f);
+int sys_log_print_msg(const char *format, ...)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
 
-	pthread_mutex_unlock(&log_mutex);
+	va_list args;
+	va_start(args, format);
+	int err = sys_log_vprint(&ts, 0, NULL, format, args);
+	va_end(args);
 
-	return 0;
+	return err;
 }
@@ -0,0 +1,298 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <system/sys_log.h>
+
+#include "sys_log_internal.h"
+
+#define SYS_LOG_RING_MASK (SYS_LOG_RING_SLOTS - 1U)
+
+/*
+ * Bounded multi-producer/single-consumer ring. Each slot carries a sequence
+ * number: a producer owns slot (pos & mask) when seq == pos, publishes it by
+ * storing pos + 1, and the writer hands it back by storing pos + SLOTS.
+ */
+struct sys_log_slot {
+	atomic_size_t seq;
+	size_t len;
+	char line[SYS_LOG_LINE_MAX];
+};
+
+static struct sys_log_slot log_ring[SYS_LOG_RING_SLOTS];
+
+static atomic_size_t ring_head;
+
+static size_t ring_tail;
+
+static atomic_ulong log_dropped;
+
+static atomic_bool async_running;
+
+/* Producers between sys_log_async_enter() and sys_log_async_leave() */
+static atomic_uint async_producers;
+
+static atomic_bool async_stop;
+
+static sem_t log_sem;
+
+static pthread_t writer_tid;
+
+static int writer_write_all(int fd, struct iovec *iov, int cnt)
+{
+	while (cnt > 0) {
+		ssize_t n = writev(fd, iov, cnt);
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return -1;
+		}
+
+		while ((cnt > 0) && ((size_t)n >= iov->iov_len)) {
+			n -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+
+		if (cnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+
+	return 0;
+}
+
+/* Writes every committed slot, returns the number of lines written */
+static size_t writer_drain(int fd)
+{
+	struct iovec iov[SYS_LOG_WRITEV_BATCH];
+	size_t total = 0U;
+
+	for (;;) {
+		size_t cnt = 0U;
+
+		while (cnt < SYS_LOG_WRITEV_BATCH) {
+			size_t pos = ring_tail + cnt;
+			struct sys_log_slot *s = &log_ring[pos & SYS_LOG_RING_MASK];
+
+			if (atomic_load_explicit(&s->seq, memory_order_acquire) !=
+			    (pos + 1U))
+				break;
+
+			iov[cnt].iov_base = s->line;
+			iov[cnt].iov_len = s->len;
+			cnt++;
+		}
+
+		if (cnt == 0U)
+			break;
+
+		if (writer_write_all(fd, iov, cnt) < 0)
+			perror("sys_log: writev");
+
+		for (size_t i = 0U; i < cnt; ++i) {
+			size_t pos = ring_tail + i;
+
+			atomic_store_explicit(
+				&log_ring[pos & SYS_LOG_RING_MASK].seq,
+				pos + SYS_LOG_RING_SLOTS, memory_order_release);
+		}
+
+		ring_tail += cnt;
+		total += cnt;
+	}
+
+	return total;
+}
+
+static void writer_report_dropped(int fd, unsigned long *reported)
+{
+	unsigned long dropped =
+		atomic_load_explicit(&log_dropped, memory_order_relaxed);
+
+	if (dropped != *reported) {
+		dprintf(fd, "sys_log: %lu messages dropped (ring full)\n",
+			dropped - *reported);
+		*reported = dropped;
+	}
+}
+
+static void *sys_log_writer_thread(void *arg)
+{
+	(void)arg;
+
+	unsigned long reported = 0UL;
+	int fd = sys_log_file_get();
+
+	for (;;) {
+		struct timespec ts;
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += (long)SYS_LOG_LIMIT_FLUSH_MS * 1000000L;
+		ts.tv_sec += ts.tv_nsec / 1000000000L;
+		ts.tv_nsec %= 1000000000L;
+
+		/* Wakes up periodically for the counts of stopped bursts */
+		while ((sem_timedwait(&log_sem, &ts) < 0) && (errno == EINTR))
+			;
+
+		sys_log_limit_flush(false);
+
+		/* Absorb the wakeups of everything drained below */
+		while (sem_trywait(&log_sem) == 0)
+			;
+
+		/* Until the log file opens, e.g. after a reload */
+		if (fd < 0)
+			fd = sys_log_file_get();
+
+		if (fd >= 0) {
+			writer_drain(fd);
+			writer_report_dropped(fd, &reported);
+		}
+
+		if (atomic_load_explicit(&async_stop, memory_order_acquire))
+			break;
+	}
+
+	if (fd >= 0) {
+		writer_drain(fd);
+		writer_report_dropped(fd, &reported);
+	}
+
+	return NULL;
+}
+
+static bool sys_log_async_is_running(void)
+{
+	return atomic_load_explicit(&async_running, memory_order_acquire);
+}
+
+bool sys_log_async_enter(void)
+{
+	/* Sequentially consistent, against the stores of the stop */
+	atomic_fetch_add(&async_producers, 1U);
+
+	if (atomic_load(&async_running))
+		return true;
+
+	atomic_fetch_sub(&async_producers, 1U);
+
+	return false;
+}
+
+void sys_log_async_leave(void)
+{
+	atomic_fetch_sub_explicit(&async_producers, 1U, memory_order_release);
+}
+
+char *sys_log_async_reserve(void **slot)
+{
+	size_t pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+
+	for (;;) {
+		struct sys_log_slot *s = &log_ring[pos & SYS_LOG_RING_MASK];
+		size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(
+				    &ring_head, &pos, pos + 1U,
+				    memory_order_relaxed,
+				    memory_order_relaxed)) {
+				*slot = s;
+				return s->line;
+			}
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&log_dropped, 1UL,
+						  memory_order_relaxed);
+			return NULL;
+		} else {
+			pos = atomic_load_explicit(&ring_head,
+						   memory_order_relaxed);
+		}
+	}
+}
+
+void sys_log_async_wake(void)
+{
+	if (sys_log_async_enter()) {
+		sem_post(&log_sem);
+		sys_log_async_leave();
+	}
+}
+
+void sys_log_async_commit(void *slot, size_t len)
+{
+	struct sys_log_slot *s = slot;
+	size_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+
+	s->len = len;
+
+	atomic_store_explicit(&s->seq, seq + 1U, memory_order_release);
+
+	sem_post(&log_sem);
+}
+
+int sys_log_start_async(void)
+{
+	if (sys_log_async_is_running())
+		return 0;
+
+	for (size_t i = 0U; i < SYS_LOG_RING_SLOTS; ++i)
+		atomic_init(&log_ring[i].seq, i);
+
+	atomic_store(&ring_head, 0U);
+	ring_tail = 0U;
+	atomic_store(&async_stop, false);
+
+	if (sem_init(&log_sem, 0, 0U) < 0)
+		return -1;
+
+	if (pthread_create(&writer_tid, NULL, sys_log_writer_thread, NULL) !=
+	    0) {
+		sem_destroy(&log_sem);
+		return -1;
+	}
+
+	atomic_store_explicit(&async_running, true, memory_order_release);
+
+	return 0;
+}
+
+void sys_log_stop_async(void)
+{
+	if (!sys_log_async_is_running())
+		return;
+
+	/* Drained below, rather than lost with the process */
+	sys_log_limit_flush(true);
+
+	atomic_store(&async_running, false);
+
+	/* Their slots are committed before the final drain of the writer */
+	while (atomic_load_explicit(&async_producers, memory_order_acquire) >
+	       0U)
+		sched_yield();
+
+	atomic_store_explicit(&async_stop, true, memory_order_release);
+	sem_post(&log_sem);
+
+	pthread_join(writer_tid, NULL);
+	sem_destroy(&log_sem);
+}
+
+unsigned long sys_log_get_dropped(void)
+{
+	return atomic_load_explicit(&log_dropped, memory_order_relaxed);
+}
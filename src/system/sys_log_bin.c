@@ -0,0 +1,318 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <system/sys_log.h>
+#include <system/sys_log_bin.h>
+
+#include "sys_log_internal.h"
+
+#define SYS_LOG_BIN_SITE_MASK (SYS_LOG_BIN_MAX_SITES - 1U)
+
+#define SYS_LOG_BIN_MODULE_MAX 32U
+
+/*
+ * A call site is identified by its format string pointer and module name.
+ * Sites are only ever added (under site_mutex) and are published by storing
+ * the format pointer last, so lookups don't need to lock. Formats that
+ * can't be encoded keep a site too, marked as text, so they fall back to
+ * TEXT records without locking again.
+ */
+struct sys_log_bin_site {
+	_Atomic(const char *) format;
+	atomic_uint gen; /**< Session in which the FMT record was emitted. */
+	bool text; /**< The format can't be encoded, log it as text. */
+	uint16_t id;
+	uint8_t nargs;
+	uint8_t types[SYS_LOG_BIN_MAX_ARGS];
+	char module[SYS_LOG_BIN_MODULE_MAX];
+};
+
+static struct sys_log_bin_site sites[SYS_LOG_BIN_MAX_SITES];
+
+static pthread_mutex_t site_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint16_t site_count;
+
+static atomic_uint session_gen = 1U;
+
+static inline char *bin_put(char *p, const void *src, size_t len)
+{
+	memcpy(p, src, len);
+	return p + len;
+}
+
+static inline uint64_t bin_timestamp(const struct timespec *ts)
+{
+	return ((uint64_t)ts->tv_sec * 1000000U) +
+	       ((uint64_t)ts->tv_nsec / 1000U);
+}
+
+static inline void bin_finish(char *buf, uint8_t type, int level, size_t len)
+{
+	struct sys_log_bin_hdr hdr = {
+		.type = type,
+		.level = (uint8_t)level,
+		.len = (uint16_t)len,
+	};
+
+	memcpy(buf, &hdr, sizeof(hdr));
+}
+
+static int bin_parse(struct sys_log_bin_site *site, const char *format)
+{
+	struct sys_log_bin_conv conv;
+	const char *p = format;
+
+	site->nargs = 0U;
+
+	while ((p = sys_log_bin_next_conv(p, &conv)) != NULL) {
+		if ((conv.type == SYS_LOG_BIN_ARG_INVALID) ||
+		    ((site->nargs + conv.star + 1U) > SYS_LOG_BIN_MAX_ARGS))
+			return -1;
+
+		for (uint8_t i = 0U; i < conv.star; ++i)
+			site->types[site->nargs++] = SYS_LOG_BIN_ARG_INT;
+
+		site->types[site->nargs++] = conv.type;
+	}
+
+	return 0;
+}
+
+static int bin_emit_fmt(const struct sys_log_bin_site *site,
+			const char *format)
+{
+	char buf[SYS_LOG_LINE_MAX];
+	uint8_t mod_len = (uint8_t)strlen(site->module);
+	size_t fixed = sizeof(struct sys_log_bin_hdr) + 6U + site->nargs +
+		       mod_len;
+	uint16_t fmt_len = (uint16_t)strnlen(format, SYS_LOG_LINE_MAX - fixed);
+	char *p = &buf[sizeof(struct sys_log_bin_hdr)];
+
+	p = bin_put(p, &site->id, sizeof(site->id));
+	*p++ = (char)site->nargs;
+	*p++ = (char)mod_len;
+	p = bin_put(p, &fmt_len, sizeof(fmt_len));
+	p = bin_put(p, site->types, site->nargs);
+	p = bin_put(p, site->module, mod_len);
+	p = bin_put(p, format, fmt_len);
+
+	bin_finish(buf, SYS_LOG_BIN_REC_FMT, 0, (size_t)(p - buf));
+
+	return sys_log_emit(buf, (size_t)(p - buf));
+}
+
+static struct sys_log_bin_site *bin_site_insert(size_t hash,
+						 const char *module,
+						 const char *format)
+{
+	struct sys_log_bin_site *site = NULL;
+
+	pthread_mutex_lock(&site_mutex);
+
+	for (size_t i = 0U; i < SYS_LOG_BIN_MAX_SITES; ++i) {
+		struct sys_log_bin_site *s =
+			&sites[(hash + i) & SYS_LOG_BIN_SITE_MASK];
+		const char *f =
+			atomic_load_explicit(&s->format, memory_order_relaxed);
+
+		if (f == NULL) {
+			s->text = (bin_parse(s, format) < 0);
+
+			if (!s->text)
+				s->id = site_count++;
+
+			strcpy(s->module, module);
+			atomic_init(&s->gen, 0U);
+			atomic_store_explicit(&s->format, format,
+					      memory_order_release);
+			site = s;
+			break;
+		}
+
+		if ((f == format) && (strcmp(s->module, module) == 0)) {
+			site = s;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&site_mutex);
+
+	return site;
+}
+
+const struct sys_log_bin_site *sys_log_bin_site_get(const char *module,
+						    const char *format)
+{
+	struct sys_log_bin_site *site = NULL;
+	size_t hash = ((uintptr_t)format >> 3) * 2654435761U;
+
+	if (module == NULL)
+		module = "";
+
+	if (strlen(module) >= SYS_LOG_BIN_MODULE_MAX)
+		return NULL;
+
+	for (size_t i = 0U; i < SYS_LOG_BIN_MAX_SITES; ++i) {
+		struct sys_log_bin_site *s =
+			&sites[(hash + i) & SYS_LOG_BIN_SITE_MASK];
+		const char *f =
+			atomic_load_explicit(&s->format, memory_order_acquire);
+
+		if (f == NULL) {
+			site = bin_site_insert(hash, module, format);
+			break;
+		}
+
+		if ((f == format) && (strcmp(s->module, module) == 0)) {
+			site = s;
+			break;
+		}
+	}
+
+	if ((site == NULL) || site->text)
+		return NULL;
+
+	/*
+	 * The definition goes out before the first event of every session.
+	 * Racing threads may both emit it, which the decoder tolerates. If
+	 * it is lost, e.g. to a full ring, the event goes out as text and
+	 * the next one tries again.
+	 */
+	unsigned int gen =
+		atomic_load_explicit(&session_gen, memory_order_acquire);
+
+	if (atomic_load_explicit(&site->gen, memory_order_acquire) != gen) {
+		if (bin_emit_fmt(site, format) != 0)
+			return NULL;
+
+		atomic_store_explicit(&site->gen, gen, memory_order_release);
+	}
+
+	return site;
+}
+
+size_t sys_log_bin_encode_event(char *buf, const struct sys_log_bin_site *site,
+				const struct timespec *ts, int level,
+				va_list args)
+{
+	char *p = &buf[sizeof(struct sys_log_bin_hdr)];
+	char *end = &buf[SYS_LOG_LINE_MAX];
+	uint64_t stamp = bin_timestamp(ts);
+
+	p = bin_put(p, &site->id, sizeof(site->id));
+	p = bin_put(p, &stamp, sizeof(stamp));
+
+	for (uint8_t i = 0U; i < site->nargs; ++i) {
+		int32_t i32;
+		int64_t i64;
+		double f64;
+		const char *str;
+		size_t len;
+
+		switch (site->types[i]) {
+		case SYS_LOG_BIN_ARG_INT:
+			i32 = va_arg(args, int);
+			p = bin_put(p, &i32, sizeof(i32));
+			break;
+		case SYS_LOG_BIN_ARG_LONG:
+			i64 = va_arg(args, long);
+			p = bin_put(p, &i64, sizeof(i64));
+			break;
+		case SYS_LOG_BIN_ARG_LLONG:
+			i64 = va_arg(args, long long);
+			p = bin_put(p, &i64, sizeof(i64));
+			break;
+		case SYS_LOG_BIN_ARG_SIZE:
+			i64 = (int64_t)va_arg(args, size_t);
+			p = bin_put(p, &i64, sizeof(i64));
+			break;
+		case SYS_LOG_BIN_ARG_PTR:
+			i64 = (int64_t)(uintptr_t)va_arg(args, void *);
+			p = bin_put(p, &i64, sizeof(i64));
+			break;
+		case SYS_LOG_BIN_ARG_DOUBLE:
+			f64 = va_arg(args, double);
+			p = bin_put(p, &f64, sizeof(f64));
+			break;
+		case SYS_LOG_BIN_ARG_STR:
+			str = va_arg(args, const char *);
+
+			if (str == NULL)
+				str = "(null)";
+
+			/* Leave room for the worst case of the remaining args */
+			len = (size_t)(end - p) - 1U -
+			      ((site->nargs - i - 1U) * sizeof(i64));
+			len = strnlen(str, (len > UINT8_MAX) ? UINT8_MAX : len);
+
+			*p++ = (char)len;
+			p = bin_put(p, str, len);
+			break;
+		default:
+			break;
+		}
+	}
+
+	bin_finish(buf, SYS_LOG_BIN_REC_EVENT, level, (size_t)(p - buf));
+
+	return (size_t)(p - buf);
+}
+
+size_t sys_log_bin_encode_text(char *buf, const struct timespec *ts, int level,
+			       const char *module, const char *format,
+			       va_list args)
+{
+	char *p = &buf[sizeof(struct sys_log_bin_hdr)];
+	uint64_t stamp = bin_timestamp(ts);
+	uint8_t mod_len = 0U;
+
+	if (module != NULL)
+		mod_len = (uint8_t)strnlen(module, SYS_LOG_BIN_MODULE_MAX);
+
+	p = bin_put(p, &stamp, sizeof(stamp));
+	*p++ = (char)mod_len;
+
+	if (mod_len > 0U)
+		p = bin_put(p, module, mod_len);
+
+	size_t room = (size_t)(&buf[SYS_LOG_LINE_MAX] - p);
+	int n = vsnprintf(p, room, format, args);
+
+	if (n > 0)
+		p += ((size_t)n < room) ? (size_t)n : (room - 1U);
+
+	bin_finish(buf, SYS_LOG_BIN_REC_TEXT, level, (size_t)(p - buf));
+
+	return (size_t)(p - buf);
+}
+
+void sys_log_bin_new_session(void)
+{
+	char buf[sizeof(struct sys_log_bin_hdr) + 14U];
+	char *p = &buf[sizeof(struct sys_log_bin_hdr)];
+	uint32_t magic = SYS_LOG_BIN_MAGIC;
+	uint16_t version = SYS_LOG_BIN_VERSION;
+	struct timespec ts;
+	uint64_t stamp;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	stamp = bin_timestamp(&ts);
+
+	p = bin_put(p, &magic, sizeof(magic));
+	p = bin_put(p, &version, sizeof(version));
+	p = bin_put(p, &stamp, sizeof(stamp));
+
+	bin_finish(buf, SYS_LOG_BIN_REC_SESSION, 0, sizeof(buf));
+
+	/* Every site must redefine its format in the new session */
+	atomic_fetch_add_explicit(&session_gen, 1U, memory_order_acq_rel);
+
+	sys_log_emit(buf, sizeof(buf));
+}
@@ -0,0 +1,196 @@
+#ifndef SYS_LOG_INTERNAL_H_
+#define SYS_LOG_INTERNAL_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Maximum length of a log line or binary record, including the newline */
+#define SYS_LOG_LINE_MAX 256U
+
+/* Number of slots in the asynchronous ring, must be a power of two */
+#define SYS_LOG_RING_SLOTS 512U
+
+/* Maximum number of lines written by a single writev() call */
+#define SYS_LOG_WRITEV_BATCH 64U
+
+/* Maximum number of modules with their own log level */
+#define SYS_LOG_LEVEL_MODULES 16U
+#define SYS_LOG_LEVEL_MODULE_MAX 32U
+
+/*
+ * Default rate limit of errors and warnings: 3 in a row, then 1 every 15
+ * minutes, slower than the longest task period so periodic errors throttle
+ */
+#define SYS_LOG_LIMIT_BURST 3U
+#define SYS_LOG_LIMIT_INTERVAL_MS 900000U
+
+/* Period of the asynchronous writer checks for pending suppression counts */
+#define SYS_LOG_LIMIT_FLUSH_MS 1000U
+
+/**
+ * \brief Gets the log file descriptor, opening the log file on first use.
+ *
+ * The descriptor stays valid for the lifetime of the process; rotation
+ * replaces the file behind it (see sys_log_reopen()).
+ *
+ * \return The descriptor, -1 if the log file can't be opened.
+ */
+int sys_log_file_get(void);
+
+/**
+ * \brief Enters the asynchronous backend as a producer.
+ *
+ * A producer that entered is waited for by sys_log_stop_async(), so its
+ * message is drained before the backend stops. Must be paired with
+ * sys_log_async_leave() when it returns true.
+ *
+ * \return true if the backend is accepting messages, false otherwise.
+ */
+bool sys_log_async_enter(void);
+
+/**
+ * \brief Leaves the asynchronous backend, after the slot was committed.
+ */
+void sys_log_async_leave(void);
+
+/**
+ * \brief Reserves a ring slot for a new log line.
+ *
+ * \param[out] slot is the reserved slot handle, to be passed to
+ * sys_log_async_commit().
+ *
+ * \return A buffer of SYS_LOG_LINE_MAX bytes, NULL if the ring is full.
+ */
+char *sys_log_async_reserve(void **slot);
+
+/**
+ * \brief Publishes a reserved slot to the writer thread.
+ *
+ * \param[in] slot is the handle returned by sys_log_async_reserve().
+ *
+ * \param[in] len is the number of valid bytes in the slot buffer.
+ */
+void sys_log_async_commit(void *slot, size_t len);
+
+/**
+ * \brief Wakes the writer thread, e.g. once the log file can be opened.
+ */
+void sys_log_async_wake(void);
+
+/**
+ * \brief Checks if the flight recorder is mapped.
+ */
+bool sys_log_rec_is_running(void);
+
+/**
+ * \brief Claims the next flight recorder slot, overwriting the oldest entry.
+ *
+ * \param[out] idx is the index of the claimed entry.
+ *
+ * \return A buffer of SYS_LOG_LINE_MAX bytes.
+ */
+char *sys_log_rec_reserve(uint64_t *idx);
+
+/**
+ * \brief Marks a claimed flight recorder slot as valid.
+ *
+ * \param[in] idx is the index returned by sys_log_rec_reserve().
+ *
+ * \param[in] len is the number of valid bytes in the slot buffer.
+ *
+ * \param[in] format is the enum sys_log_format of the slot buffer.
+ */
+void sys_log_rec_commit(uint64_t idx, size_t len, int format);
+
+/**
+ * \brief Checks the rate limit of a message against its token bucket.
+ *
+ * \param[in] level is the level of the message.
+ *
+ * \param[in] module is the module of the message.
+ *
+ * \param[in] format is the format string of the message.
+ *
+ * \param[out] repeated is the number of messages suppressed since the last
+ * one that passed, only set when this one passes.
+ *
+ * \return true if the message should be printed, false otherwise.
+ */
+bool sys_log_limit_check(int level, const char *module, const char *format,
+			 unsigned int *repeated);
+
+/**
+ * \brief Reports the messages suppressed by the rate limit.
+ *
+ * A count is otherwise only reported with the next message of its key, so
+ * it would be lost when a burst stops.
+ *
+ * \param[in] all reports every pending count if true, else only those of
+ * keys whose next message would pass, i.e. whose burst stopped.
+ */
+void sys_log_limit_flush(bool all);
+
+/**
+ * \brief Prints the number of suppressed messages of a key.
+ *
+ * \param[in] level is the level of the suppressed messages.
+ *
+ * \param[in] module is their module.
+ *
+ * \param[in] format is their format string.
+ *
+ * \param[in] count is the number of messages suppressed.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_print_suppressed(int level, const char *module,
+			     const char *format, unsigned int count);
+
+/**
+ * \brief Writes an already encoded line or record to the log.
+ *
+ * \return 0 on success, -1 otherwise.
+ */
+int sys_log_emit(const char *buf, size_t len);
+
+struct sys_log_bin_site;
+
+/**
+ * \brief Looks up (or registers) the binary log call site of a message.
+ *
+ * The FMT record of the site is emitted the first time it is used in a
+ * session.
+ *
+ * \return The site, NULL if the format can't be encoded in binary form or
+ * its FMT record could not be emitted.
+ */
+const struct sys_log_bin_site *sys_log_bin_site_get(const char *module,
+						    const char *format);
+
+/**
+ * \brief Encodes an EVENT record with the raw arguments of a message.
+ *
+ * \return The record length.
+ */
+size_t sys_log_bin_encode_event(char *buf, const struct sys_log_bin_site *site,
+				const struct timespec *ts, int level,
+				va_list args);
+
+/**
+ * \brief Encodes a TEXT record for messages without a call site.
+ *
+ * \return The record length.
+ */
+size_t sys_log_bin_encode_text(char *buf, const struct timespec *ts, int level,
+			       const char *module, const char *format,
+			       va_list args);
+
+/**
+ * \brief Starts a new binary log session, emitting a SESSION record.
+ */
+void sys_log_bin_new_session(void);
+
+#endif
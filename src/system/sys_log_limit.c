@@ -0,0 +1,190 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <system/sys_log.h>
+
+#include "sys_log_internal.h"
+
+#define SYS_LOG_LIMIT_KEYS 128U
+
+#define SYS_LOG_LIMIT_KEY_MASK (SYS_LOG_LIMIT_KEYS - 1U)
+
+#define SYS_LOG_LIMIT_MODULE_MAX 32U
+
+/*
+ * Per-key token bucket, implemented as a GCRA: tat is the theoretical arrival
+ * time of the next message. A message passes if tat is at most (burst - 1)
+ * intervals ahead of now, and then pushes tat one interval further. Keys are
+ * added under key_mutex and published by storing the format pointer last.
+ * The level of the last suppressed message is kept for the flush.
+ */
+struct sys_log_limit_key {
+	_Atomic(const char *) format;
+	atomic_uint_least64_t tat;
+	atomic_uint suppressed;
+	atomic_int level;
+	char module[SYS_LOG_LIMIT_MODULE_MAX];
+};
+
+static struct sys_log_limit_key keys[SYS_LOG_LIMIT_KEYS];
+
+static pthread_mutex_t key_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_uint limit_burst = SYS_LOG_LIMIT_BURST;
+
+static atomic_uint limit_interval_ms = SYS_LOG_LIMIT_INTERVAL_MS;
+
+static struct sys_log_limit_key *limit_key_insert(size_t hash,
+						  const char *module,
+						  const char *format)
+{
+	struct sys_log_limit_key *key = NULL;
+
+	pthread_mutex_lock(&key_mutex);
+
+	for (size_t i = 0U; i < SYS_LOG_LIMIT_KEYS; ++i) {
+		struct sys_log_limit_key *k =
+			&keys[(hash + i) & SYS_LOG_LIMIT_KEY_MASK];
+		const char *f =
+			atomic_load_explicit(&k->format, memory_order_relaxed);
+
+		if (f == NULL) {
+			strcpy(k->module, module);
+			atomic_init(&k->tat, 0U);
+			atomic_init(&k->suppressed, 0U);
+			atomic_init(&k->level, 0);
+			atomic_store_explicit(&k->format, format,
+					      memory_order_release);
+			key = k;
+			break;
+		}
+
+		if ((f == format) && (strcmp(k->module, module) == 0)) {
+			key = k;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&key_mutex);
+
+	return key;
+}
+
+static struct sys_log_limit_key *limit_key_get(const char *module,
+					       const char *format)
+{
+	size_t hash = ((uintptr_t)format >> 3) * 2654435761U;
+
+	for (size_t i = 0U; i < SYS_LOG_LIMIT_KEYS; ++i) {
+		struct sys_log_limit_key *k =
+			&keys[(hash + i) & SYS_LOG_LIMIT_KEY_MASK];
+		const char *f =
+			atomic_load_explicit(&k->format, memory_order_acquire);
+
+		if (f == NULL)
+			return limit_key_insert(hash, module, format);
+
+		if ((f == format) && (strcmp(k->module, module) == 0))
+			return k;
+	}
+
+	return NULL;
+}
+
+static uint64_t limit_now_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000U) +
+	       ((uint64_t)ts.tv_nsec / 1000000U);
+}
+
+bool sys_log_limit_check(int level, const char *module, const char *format,
+			 unsigned int *repeated)
+{
+	unsigned int burst =
+		atomic_load_explicit(&limit_burst, memory_order_relaxed);
+	uint64_t interval =
+		atomic_load_explicit(&limit_interval_ms, memory_order_relaxed);
+
+	*repeated = 0U;
+
+	if ((burst == 0U) || (interval == 0U) ||
+	    (strlen(module) >= SYS_LOG_LIMIT_MODULE_MAX))
+		return true;
+
+	struct sys_log_limit_key *key = limit_key_get(module, format);
+
+	if (key == NULL)
+		return true;
+
+	uint64_t now = limit_now_ms();
+	uint64_t limit = now + ((uint64_t)(burst - 1U) * interval);
+	uint64_t tat = atomic_load_explicit(&key->tat, memory_order_relaxed);
+
+	do {
+		if (tat > limit) {
+			atomic_store_explicit(&key->level, level,
+					      memory_order_relaxed);
+			atomic_fetch_add_explicit(&key->suppressed, 1U,
+						  memory_order_relaxed);
+			return false;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(
+		&key->tat, &tat, ((tat > now) ? tat : now) + interval,
+		memory_order_relaxed, memory_order_relaxed));
+
+	*repeated = atomic_exchange_explicit(&key->suppressed, 0U,
+					     memory_order_relaxed);
+
+	return true;
+}
+
+void sys_log_limit_flush(bool all)
+{
+	unsigned int burst =
+		atomic_load_explicit(&limit_burst, memory_order_relaxed);
+	uint64_t interval =
+		atomic_load_explicit(&limit_interval_ms, memory_order_relaxed);
+	uint64_t limit = limit_now_ms();
+
+	if (burst > 0U)
+		limit += (uint64_t)(burst - 1U) * interval;
+
+	for (size_t i = 0U; i < SYS_LOG_LIMIT_KEYS; ++i) {
+		struct sys_log_limit_key *k = &keys[i];
+		const char *f =
+			atomic_load_explicit(&k->format, memory_order_acquire);
+
+		if ((f == NULL) || (atomic_load_explicit(&k->suppressed,
+							 memory_order_relaxed) ==
+				    0U))
+			continue;
+
+		/* Still throttled, the count goes with the next message */
+		if (!all && (atomic_load_explicit(&k->tat,
+						  memory_order_relaxed) > limit))
+			continue;
+
+		unsigned int count = atomic_exchange_explicit(
+			&k->suppressed, 0U, memory_order_relaxed);
+
+		if (count > 0U)
+			sys_log_print_suppressed(
+				atomic_load_explicit(&k->level,
+						     memory_order_relaxed),
+				k->module, f, count);
+	}
+}
+
+void sys_log_set_rate_limit(unsigned int burst, unsigned int interval_ms)
+{
+	atomic_store_explicit(&limit_burst, burst, memory_order_relaxed);
+	atomic_store_explicit(&limit_interval_ms, interval_ms,
+			      memory_order_relaxed);
+}
@@ -0,0 +1,123 @@
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <system/sys_log.h>
+#include <system/sys_log_rec.h>
+
+#include "sys_log_internal.h"
+
+_Static_assert(SYS_LOG_REC_DATA_MAX == SYS_LOG_LINE_MAX,
+	       "recorder slots must hold a full log line");
+
+/*
+ * The header and slots live in a shared mapping that outlives the process,
+ * so they are plain integers accessed through the __atomic builtins.
+ */
+static struct sys_log_rec_hdr *rec_hdr;
+
+static struct sys_log_rec_slot *rec_slots;
+
+static atomic_bool rec_running;
+
+static bool rec_hdr_matches(const struct sys_log_rec_hdr *hdr, uint32_t slots)
+{
+	return (hdr->magic == SYS_LOG_REC_MAGIC) &&
+	       (hdr->version == SYS_LOG_REC_VERSION) &&
+	       (hdr->hdr_size == SYS_LOG_REC_HDR_SIZE) &&
+	       (hdr->slot_size == sizeof(struct sys_log_rec_slot)) &&
+	       (hdr->slots == slots);
+}
+
+bool sys_log_rec_is_running(void)
+{
+	return atomic_load_explicit(&rec_running, memory_order_acquire);
+}
+
+char *sys_log_rec_reserve(uint64_t *idx)
+{
+	*idx = __atomic_fetch_add(&rec_hdr->head, 1U, __ATOMIC_RELAXED);
+
+	struct sys_log_rec_slot *s = &rec_slots[*idx % rec_hdr->slots];
+
+	if (*idx >= rec_hdr->slots)
+		__atomic_store_n(&rec_hdr->tail, *idx + 1U - rec_hdr->slots,
+				 __ATOMIC_RELAXED);
+
+	/* Invalidate the old entry before its data gets overwritten */
+	__atomic_store_n(&s->seq, 0U, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	return s->data;
+}
+
+void sys_log_rec_commit(uint64_t idx, size_t len, int format)
+{
+	struct sys_log_rec_slot *s = &rec_slots[idx % rec_hdr->slots];
+
+	s->len = (uint32_t)len;
+	s->format = (uint32_t)format;
+
+	__atomic_store_n(&s->seq, idx + 1U, __ATOMIC_RELEASE);
+}
+
+int sys_log_start_recorder(const char *path, unsigned int slots)
+{
+	size_t size = SYS_LOG_REC_HDR_SIZE +
+		      ((size_t)slots * sizeof(struct sys_log_rec_slot));
+
+	if (sys_log_rec_is_running())
+		return 0;
+
+	if (slots == 0U)
+		return -1;
+
+	int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		perror("sys_log: recorder open");
+		return -1;
+	}
+
+	struct stat st;
+
+	if ((fstat(fd, &st) < 0) ||
+	    (((size_t)st.st_size != size) && (ftruncate(fd, size) < 0))) {
+		perror("sys_log: recorder resize");
+		close(fd);
+		return -1;
+	}
+
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		perror("sys_log: recorder mmap");
+		return -1;
+	}
+
+	rec_hdr = map;
+	rec_slots = (struct sys_log_rec_slot *)((char *)map +
+						SYS_LOG_REC_HDR_SIZE);
+
+	/* Keep the entries of a previous run, they may explain its crash */
+	if (!rec_hdr_matches(rec_hdr, slots)) {
+		memset(map, 0, size);
+
+		rec_hdr->magic = SYS_LOG_REC_MAGIC;
+		rec_hdr->version = SYS_LOG_REC_VERSION;
+		rec_hdr->hdr_size = SYS_LOG_REC_HDR_SIZE;
+		rec_hdr->slot_size = sizeof(struct sys_log_rec_slot);
+		rec_hdr->slots = slots;
+	}
+
+	atomic_store_explicit(&rec_running, true, memory_order_release);
+
+	return 0;
+}
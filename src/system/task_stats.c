@@ -0,0 +1,134 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <system/sys_log.h>
+#include <system/task_stats.h>
+
+#define TASK_STATS_MODULE_NAME "stats"
+
+static _Atomic(struct task_stats *) stats_list;
+
+static unsigned int task_stats_bucket(uint64_t ns)
+{
+	if (ns < TASK_STATS_SUB_COUNT)
+		return (unsigned int)ns;
+
+	unsigned int exp = 63U - (unsigned int)__builtin_clzll(ns);
+	unsigned int shift = exp - TASK_STATS_SUB_BITS;
+
+	return ((shift + 1U) * TASK_STATS_SUB_COUNT) +
+	       (unsigned int)((ns >> shift) & (TASK_STATS_SUB_COUNT - 1U));
+}
+
+/* Largest value falling in a bucket */
+static uint64_t task_stats_bucket_max(unsigned int bucket)
+{
+	if (bucket < TASK_STATS_SUB_COUNT)
+		return bucket;
+
+	unsigned int shift = (bucket / TASK_STATS_SUB_COUNT) - 1U;
+	uint64_t base = (uint64_t)(TASK_STATS_SUB_COUNT +
+				   (bucket % TASK_STATS_SUB_COUNT))
+			<< shift;
+
+	return base + ((1ULL << shift) - 1U);
+}
+
+void task_stats_record(struct task_stats_hist *hist, uint64_t ns)
+{
+	atomic_fetch_add_explicit(&hist->count[task_stats_bucket(ns)], 1UL,
+				  memory_order_relaxed);
+
+	uint64_t max = atomic_load_explicit(&hist->max, memory_order_relaxed);
+
+	while ((ns > max) &&
+	       !atomic_compare_exchange_weak_explicit(&hist->max, &max, ns,
+						      memory_order_relaxed,
+						      memory_order_relaxed)) {
+	}
+}
+
+uint64_t task_stats_percentile(const struct task_stats_hist *hist,
+			       unsigned int pct)
+{
+	unsigned long counts[TASK_STATS_BUCKETS];
+	unsigned long total = 0UL;
+
+	/* Works on a copy, so a concurrent record can't move the target */
+	for (unsigned int i = 0U; i < TASK_STATS_BUCKETS; ++i) {
+		counts[i] = atomic_load_explicit(&hist->count[i],
+						 memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (total == 0UL)
+		return 0U;
+
+	uint64_t max = atomic_load_explicit(&hist->max, memory_order_relaxed);
+	unsigned long target = ((total * pct) + 99UL) / 100UL;
+	unsigned long seen = 0UL;
+
+	if (target == 0UL)
+		target = 1UL;
+
+	for (unsigned int i = 0U; i < TASK_STATS_BUCKETS; ++i) {
+		seen += counts[i];
+
+		if ((seen >= target) && (task_stats_bucket_max(i) < max))
+			return task_stats_bucket_max(i);
+
+		if (seen >= target)
+			break;
+	}
+
+	return max;
+}
+
+void task_stats_register(struct task_stats *stats, const char *name)
+{
+	struct task_stats *head =
+		atomic_load_explicit(&stats_list, memory_order_relaxed);
+
+	stats->name = name;
+
+	do {
+		stats->next = head;
+	} while (!atomic_compare_exchange_weak_explicit(
+		&stats_list, &head, stats, memory_order_release,
+		memory_order_relaxed));
+}
+
+static void task_stats_dump_hist(const char *name, const char *what,
+				 const struct task_stats_hist *hist)
+{
+	sys_log_print_msg(
+		TASK_STATS_MODULE_NAME
+		": %s %s (us): p50 %lu, p90 %lu, p99 %lu, max %lu",
+		name, what,
+		(unsigned long)(task_stats_percentile(hist, 50U) / 1000U),
+		(unsigned long)(task_stats_percentile(hist, 90U) / 1000U),
+		(unsigned long)(task_stats_percentile(hist, 99U) / 1000U),
+		(unsigned long)(atomic_load_explicit(&hist->max,
+						     memory_order_relaxed) /
+				1000U));
+}
+
+/* Asked for by SIGUSR1, so printed whatever the log levels */
+void task_stats_dump(void)
+{
+	for (struct task_stats *s =
+		     atomic_load_explicit(&stats_list, memory_order_acquire);
+	     s != NULL; s = s->next) {
+		sys_log_print_msg(
+			TASK_STATS_MODULE_NAME
+			": %s: %lu cycles, %lu deadline overruns",
+			s->name,
+			atomic_load_explicit(&s->cycles, memory_order_relaxed),
+			atomic_load_explicit(&s->overruns,
+					     memory_order_relaxed));
+
+		task_stats_dump_hist(s->name, "lateness", &s->lateness);
+		task_stats_dump_hist(s->name, "duration", &s->duration);
+	}
+}
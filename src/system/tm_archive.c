@@ -0,0 +1,438 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <system/sys_log.h>
+#include <system/tm_archive.h>
+#include <system/tm_fields.h>
+
+#define TM_ARCHIVE_MODULE_NAME "archive"
+
+#define TM_ARCHIVE_DIR_MAX 200U
+
+#define TM_ARCHIVE_DAY_US 86400000000ULL
+
+/* Oldest pending sample of a partial block, lost if the process dies */
+#define TM_ARCHIVE_FLUSH_AGE_US (5ULL * 60ULL * 1000000ULL)
+
+/* Largest BLOCK record, every value taking a full varint */
+#define TM_ARCHIVE_REC_MAX                                                     \
+	(sizeof(struct tm_archive_rec_hdr) + 20U +                            \
+	 ((TM_FIELDS_MAX + 1U) *                                               \
+	  ((TM_ARCHIVE_BLOCK_SAMPLES * TM_ARCHIVE_VARINT_MAX) + 4U)) +         \
+	 sizeof(struct tm_archive_rec_end))
+
+struct tm_archive_series {
+	enum tm_pub_type type;
+	uint8_t instance;
+	bool schema; /* SCHEMA written to the current file */
+	unsigned int count;
+	uint64_t ts[TM_ARCHIVE_BLOCK_SAMPLES];
+	int64_t vals[TM_FIELDS_MAX][TM_ARCHIVE_BLOCK_SAMPLES];
+};
+
+static struct tm_archive_series tm_archive_series[] = {
+	{ .type = TM_PUB_EPS_DATA, .instance = 0U },
+	{ .type = TM_PUB_TTC_DATA, .instance = 0U },
+	{ .type = TM_PUB_TTC_DATA, .instance = 1U },
+	{ .type = TM_PUB_EDC_HK, .instance = 0U },
+};
+
+#define TM_ARCHIVE_SERIES_COUNT                                                \
+	(sizeof(tm_archive_series) / sizeof(tm_archive_series[0]))
+
+static uint8_t tm_archive_buf[TM_ARCHIVE_REC_MAX];
+
+static char tm_archive_dir[TM_ARCHIVE_DIR_MAX];
+
+static bool tm_archive_running;
+
+static int tm_archive_fd = -1;
+
+static uint64_t tm_archive_day; /* Of the open file */
+
+static off_t tm_archive_size; /* Of the valid records of the open file */
+
+static pthread_mutex_t tm_archive_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct tm_archive_series *tm_archive_find(enum tm_pub_type type,
+						 uint8_t instance)
+{
+	for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i) {
+		if ((tm_archive_series[i].type == type) &&
+		    (tm_archive_series[i].instance == instance))
+			return &tm_archive_series[i];
+	}
+
+	return NULL;
+}
+
+/* Appends a record, cutting a partial write off so the file stays valid */
+static int tm_archive_write(const uint8_t *buf, size_t len)
+{
+	size_t done = 0U;
+
+	while (done < len) {
+		ssize_t ret = write(tm_archive_fd, &buf[done], len - done);
+
+		if ((ret < 0) && (errno == EINTR))
+			continue;
+
+		if (ret <= 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, TM_ARCHIVE_MODULE_NAME,
+				"Failed to write: %s",
+				(ret < 0) ? strerror(errno) : "no space");
+
+			if ((done > 0U) &&
+			    (ftruncate(tm_archive_fd, tm_archive_size) != 0)) {
+				close(tm_archive_fd);
+				tm_archive_fd = -1;
+			}
+
+			return -1;
+		}
+
+		done += (size_t)ret;
+	}
+
+	tm_archive_size += (off_t)len;
+
+	return 0;
+}
+
+/* Wraps the body ending at end in a record, returns the record length */
+static size_t tm_archive_record(uint8_t *end, enum tm_archive_rec rec,
+				const struct tm_archive_series *s,
+				unsigned int nfields)
+{
+	struct tm_archive_rec_end tail = {
+		.len = (uint32_t)((size_t)(end - tm_archive_buf) + sizeof(tail)),
+		.magic = TM_ARCHIVE_REC_MAGIC,
+	};
+	struct tm_archive_rec_hdr hdr = {
+		.len = tail.len,
+		.rec = (uint8_t)rec,
+		.type = (uint8_t)s->type,
+		.instance = s->instance,
+		.nfields = (uint8_t)nfields,
+	};
+
+	memcpy(tm_archive_buf, &hdr, sizeof(hdr));
+	memcpy(end, &tail, sizeof(tail));
+
+	return tail.len;
+}
+
+static int tm_archive_write_schema(const struct tm_archive_series *s)
+{
+	unsigned int nfields = 0U;
+	const struct tm_field *fields = tm_fields_get(s->type, &nfields, NULL);
+	uint8_t *p = &tm_archive_buf[sizeof(struct tm_archive_rec_hdr)];
+
+	for (unsigned int f = 0U; f < nfields; ++f) {
+		size_t len = strlen(fields[f].name);
+
+		*p++ = (uint8_t)fields[f].kind;
+		*p++ = (uint8_t)len;
+		memcpy(p, fields[f].name, len);
+		p += len;
+	}
+
+	return tm_archive_write(tm_archive_buf,
+				tm_archive_record(p, TM_ARCHIVE_REC_SCHEMA, s,
+						  nfields));
+}
+
+static int tm_archive_write_block(const struct tm_archive_series *s)
+{
+	unsigned int nfields = 0U;
+	uint8_t *p = &tm_archive_buf[sizeof(struct tm_archive_rec_hdr)];
+	uint32_t offsets[TM_FIELDS_MAX + 1U];
+	uint32_t count = s->count;
+	uint64_t prev = s->ts[0];
+	int64_t prev_delta = 0;
+
+	(void)tm_fields_get(s->type, &nfields, NULL);
+
+	memcpy(p, &count, sizeof(count));
+	memcpy(&p[4], &s->ts[0], sizeof(s->ts[0]));
+	memcpy(&p[12], &s->ts[count - 1U], sizeof(s->ts[0]));
+	p += 20;
+
+	/* A steady period makes the timestamps a run of zeros */
+	offsets[0] = (uint32_t)(p - tm_archive_buf);
+
+	for (unsigned int i = 0U; i < count; ++i) {
+		int64_t delta = (int64_t)(s->ts[i] - prev);
+
+		p += tm_archive_put_varint(
+			p, tm_archive_zigzag(delta - prev_delta));
+		prev = s->ts[i];
+		prev_delta = delta;
+	}
+
+	for (unsigned int f = 0U; f < nfields; ++f) {
+		int64_t last = 0;
+
+		offsets[f + 1U] = (uint32_t)(p - tm_archive_buf);
+
+		for (unsigned int i = 0U; i < count; ++i) {
+			p += tm_archive_put_varint(
+				p, tm_archive_zigzag(s->vals[f][i] - last));
+			last = s->vals[f][i];
+		}
+	}
+
+	memcpy(p, offsets, (nfields + 1U) * sizeof(offsets[0]));
+	p += (nfields + 1U) * sizeof(offsets[0]);
+
+	return tm_archive_write(tm_archive_buf,
+				tm_archive_record(p, TM_ARCHIVE_REC_BLOCK, s,
+						  nfields));
+}
+
+/* Writes out the pending samples of a series, which are dropped on errors */
+static void tm_archive_flush(struct tm_archive_series *s)
+{
+	if ((s->count == 0U) || (tm_archive_fd < 0)) {
+		s->count = 0U;
+		return;
+	}
+
+	if (!s->schema && (tm_archive_write_schema(s) == 0))
+		s->schema = true;
+
+	if (s->schema)
+		(void)tm_archive_write_block(s);
+
+	s->count = 0U;
+}
+
+/*
+ * Finds the end of the last complete record of a file, to append after it.
+ * Returns -1 if the file is not an archive.
+ */
+static off_t tm_archive_recover(int fd, off_t size)
+{
+	struct tm_archive_file_hdr fhdr;
+
+	if ((pread(fd, &fhdr, sizeof(fhdr), 0) != (ssize_t)sizeof(fhdr)) ||
+	    (fhdr.magic != TM_ARCHIVE_MAGIC) ||
+	    (fhdr.version != TM_ARCHIVE_VERSION))
+		return -1;
+
+	off_t off = fhdr.hdr_size;
+
+	while ((off + (off_t)sizeof(struct tm_archive_rec_hdr)) <= size) {
+		struct tm_archive_rec_hdr hdr;
+		struct tm_archive_rec_end end;
+
+		if ((pread(fd, &hdr, sizeof(hdr), off) != (ssize_t)sizeof(hdr)) ||
+		    (hdr.len < (sizeof(hdr) + sizeof(end))) ||
+		    ((off + (off_t)hdr.len) > size))
+			break;
+
+		if ((pread(fd, &end, sizeof(end),
+			   off + (off_t)hdr.len - (off_t)sizeof(end)) !=
+		     (ssize_t)sizeof(end)) ||
+		    (end.len != hdr.len) || (end.magic != TM_ARCHIVE_REC_MAGIC))
+			break;
+
+		off += (off_t)hdr.len;
+	}
+
+	return off;
+}
+
+/* Opens the file of a day, appending to it if it exists */
+static int tm_archive_partition(uint64_t day)
+{
+	char path[TM_ARCHIVE_DIR_MAX + 16U];
+	char name[9]; /* YYYYMMDD */
+	time_t secs = (time_t)(day / 1000000U);
+	struct tm tm;
+	struct stat st;
+
+	gmtime_r(&secs, &tm);
+	strftime(name, sizeof(name), "%Y%m%d", &tm);
+
+	snprintf(path, sizeof(path), "%s/%s.tma", tm_archive_dir, name);
+
+	int fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	if ((fd < 0) || (fstat(fd, &st) != 0)) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						TM_ARCHIVE_MODULE_NAME,
+						"Failed to open %s: %s", path,
+						strerror(errno));
+
+		if (fd >= 0)
+			close(fd);
+
+		return -1;
+	}
+
+	tm_archive_fd = fd;
+	tm_archive_day = day;
+	tm_archive_size = 0;
+
+	for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i)
+		tm_archive_series[i].schema = false;
+
+	if (st.st_size == 0) {
+		struct tm_archive_file_hdr fhdr = {
+			.magic = TM_ARCHIVE_MAGIC,
+			.version = TM_ARCHIVE_VERSION,
+			.hdr_size = sizeof(fhdr),
+			.day = day,
+		};
+
+		if (tm_archive_write((const uint8_t *)&fhdr, sizeof(fhdr)) != 0)
+			goto fail;
+
+		return 0;
+	}
+
+	off_t end = tm_archive_recover(fd, st.st_size);
+
+	if (end < 0) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						TM_ARCHIVE_MODULE_NAME,
+						"%s is not an archive", path);
+		goto fail;
+	}
+
+	if (end < st.st_size) {
+		sys_log_print_event_from_module(
+			SYS_LOG_WARNING, TM_ARCHIVE_MODULE_NAME,
+			"Dropping %ld bytes of a torn record from %s",
+			(long)(st.st_size - end), path);
+
+		if (ftruncate(fd, end) != 0)
+			goto fail;
+	}
+
+	tm_archive_size = end;
+
+	return 0;
+
+fail:
+	if (tm_archive_fd >= 0)
+		close(tm_archive_fd);
+
+	tm_archive_fd = -1;
+
+	return -1;
+}
+
+int tm_archive_open(const char *dir)
+{
+	if (strlen(dir) >= TM_ARCHIVE_DIR_MAX)
+		return -1;
+
+	if ((mkdir(dir, 0755) != 0) && (errno != EEXIST)) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						TM_ARCHIVE_MODULE_NAME,
+						"Failed to create %s: %s", dir,
+						strerror(errno));
+		return -1;
+	}
+
+	pthread_mutex_lock(&tm_archive_lock);
+
+	strcpy(tm_archive_dir, dir);
+	tm_archive_running = true;
+
+	pthread_mutex_unlock(&tm_archive_lock);
+
+	return 0;
+}
+
+int tm_archive_append(enum tm_pub_type type, uint8_t instance,
+		      const void *data, size_t size)
+{
+	struct tm_archive_series *s = tm_archive_find(type, instance);
+	unsigned int nfields = 0U;
+	size_t len = 0U;
+	const struct tm_field *fields = tm_fields_get(type, &nfields, &len);
+	uint64_t now = tm_pub_now_us();
+	uint64_t day = now - (now % TM_ARCHIVE_DAY_US);
+
+	if ((s == NULL) || (size != len))
+		return -1;
+
+	pthread_mutex_lock(&tm_archive_lock);
+
+	if (!tm_archive_running) {
+		pthread_mutex_unlock(&tm_archive_lock);
+		return -1;
+	}
+
+	/* The blocks of a day all go to its file */
+	if ((tm_archive_fd < 0) || (day != tm_archive_day)) {
+		for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i)
+			tm_archive_flush(&tm_archive_series[i]);
+
+		if (tm_archive_fd >= 0)
+			close(tm_archive_fd);
+
+		tm_archive_fd = -1;
+
+		(void)tm_archive_partition(day);
+	}
+
+	s->ts[s->count] = now;
+
+	for (unsigned int f = 0U; f < nfields; ++f)
+		s->vals[f][s->count] = tm_fields_load(data, &fields[f]);
+
+	if (++s->count == TM_ARCHIVE_BLOCK_SAMPLES)
+		tm_archive_flush(s);
+
+	/* Slow series would hold their samples in memory for hours */
+	for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i) {
+		struct tm_archive_series *old = &tm_archive_series[i];
+
+		if ((old->count > 0U) && (now > old->ts[0]) &&
+		    ((now - old->ts[0]) >= TM_ARCHIVE_FLUSH_AGE_US))
+			tm_archive_flush(old);
+	}
+
+	pthread_mutex_unlock(&tm_archive_lock);
+
+	return 0;
+}
+
+void tm_archive_sync(void)
+{
+	pthread_mutex_lock(&tm_archive_lock);
+
+	for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i)
+		tm_archive_flush(&tm_archive_series[i]);
+
+	pthread_mutex_unlock(&tm_archive_lock);
+}
+
+void tm_archive_close(void)
+{
+	pthread_mutex_lock(&tm_archive_lock);
+
+	for (size_t i = 0U; i < TM_ARCHIVE_SERIES_COUNT; ++i)
+		tm_archive_flush(&tm_archive_series[i]);
+
+	if (tm_archive_fd >= 0)
+		close(tm_archive_fd);
+
+	tm_archive_fd = -1;
+	tm_archive_running = false;
+
+	pthread_mutex_unlock(&tm_archive_lock);
+}
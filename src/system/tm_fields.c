@@ -0,0 +1,198 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/edc.h>
+#include <drivers/sl_eps2.h>
+#include <drivers/sl_ttc2.h>
+#include <system/tm_fields.h>
+
+#define TM_FIELD_KIND(x)                                                       \
+	_Generic((x),                                                          \
+		uint8_t: TM_FIELD_U8,                                          \
+		int8_t: TM_FIELD_I8,                                           \
+		uint16_t: TM_FIELD_U16,                                        \
+		int16_t: TM_FIELD_I16,                                         \
+		uint32_t: TM_FIELD_U32,                                        \
+		int32_t: TM_FIELD_I32)
+
+#define TM_FIELD(type, member)                                                 \
+	{                                                                      \
+		#member, offsetof(type, member),                               \
+			TM_FIELD_KIND(((type *)0)->member)                     \
+	}
+
+static const struct tm_field tm_eps_fields[] = {
+	TM_FIELD(sl_eps2_data_t, time_counter),
+	TM_FIELD(sl_eps2_data_t, temperature_uc),
+	TM_FIELD(sl_eps2_data_t, current),
+	TM_FIELD(sl_eps2_data_t, last_reset_cause),
+	TM_FIELD(sl_eps2_data_t, reset_counter),
+	TM_FIELD(sl_eps2_data_t, solar_panel_voltage_my_px),
+	TM_FIELD(sl_eps2_data_t, solar_panel_voltage_mx_pz),
+	TM_FIELD(sl_eps2_data_t, solar_panel_voltage_mz_py),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_my),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_py),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_mx),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_px),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_mz),
+	TM_FIELD(sl_eps2_data_t, solar_panel_current_pz),
+	TM_FIELD(sl_eps2_data_t, mppt_1_duty_cycle),
+	TM_FIELD(sl_eps2_data_t, mppt_2_duty_cycle),
+	TM_FIELD(sl_eps2_data_t, mppt_3_duty_cycle),
+	TM_FIELD(sl_eps2_data_t, solar_panel_output_voltage),
+	TM_FIELD(sl_eps2_data_t, main_power_bus_voltage),
+	TM_FIELD(sl_eps2_data_t, rtd_0_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_1_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_2_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_3_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_4_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_5_temperature),
+	TM_FIELD(sl_eps2_data_t, rtd_6_temperature),
+	TM_FIELD(sl_eps2_data_t, battery_voltage),
+	TM_FIELD(sl_eps2_data_t, battery_current),
+	TM_FIELD(sl_eps2_data_t, battery_average_current),
+	TM_FIELD(sl_eps2_data_t, battery_acc_current),
+	TM_FIELD(sl_eps2_data_t, battery_charge),
+	TM_FIELD(sl_eps2_data_t, battery_monitor_temperature),
+	TM_FIELD(sl_eps2_data_t, battery_monitor_status),
+	TM_FIELD(sl_eps2_data_t, battery_monitor_protection),
+	TM_FIELD(sl_eps2_data_t, battery_monitor_cycle_counter),
+	TM_FIELD(sl_eps2_data_t, raac),
+	TM_FIELD(sl_eps2_data_t, rsac),
+	TM_FIELD(sl_eps2_data_t, rarc),
+	TM_FIELD(sl_eps2_data_t, rsrc),
+	TM_FIELD(sl_eps2_data_t, battery_heater_1_duty_cycle),
+	TM_FIELD(sl_eps2_data_t, battery_heater_2_duty_cycle),
+	TM_FIELD(sl_eps2_data_t, mppt_1_mode),
+	TM_FIELD(sl_eps2_data_t, mppt_2_mode),
+	TM_FIELD(sl_eps2_data_t, mppt_3_mode),
+	TM_FIELD(sl_eps2_data_t, battery_heater_1_mode),
+	TM_FIELD(sl_eps2_data_t, battery_heater_2_mode),
+};
+
+static const struct tm_field tm_ttc_fields[] = {
+	TM_FIELD(sl_ttc2_hk_data_t, time_counter),
+	TM_FIELD(sl_ttc2_hk_data_t, reset_counter),
+	TM_FIELD(sl_ttc2_hk_data_t, last_reset_cause),
+	TM_FIELD(sl_ttc2_hk_data_t, voltage_mcu),
+	TM_FIELD(sl_ttc2_hk_data_t, current_mcu),
+	TM_FIELD(sl_ttc2_hk_data_t, temperature_mcu),
+	TM_FIELD(sl_ttc2_hk_data_t, voltage_radio),
+	TM_FIELD(sl_ttc2_hk_data_t, current_radio),
+	TM_FIELD(sl_ttc2_hk_data_t, temperature_radio),
+	TM_FIELD(sl_ttc2_hk_data_t, last_valid_tc),
+	TM_FIELD(sl_ttc2_hk_data_t, rssi_last_valid_tc),
+	TM_FIELD(sl_ttc2_hk_data_t, temperature_antenna),
+	TM_FIELD(sl_ttc2_hk_data_t, antenna_status),
+	TM_FIELD(sl_ttc2_hk_data_t, deployment_status),
+	TM_FIELD(sl_ttc2_hk_data_t, hibernation_status),
+	TM_FIELD(sl_ttc2_hk_data_t, tx_packet_counter),
+	TM_FIELD(sl_ttc2_hk_data_t, rx_packet_counter),
+};
+
+static const struct tm_field tm_edc_hk_fields[] = {
+	TM_FIELD(edc_hk_t, current_time),
+	TM_FIELD(edc_hk_t, elapsed_time),
+	TM_FIELD(edc_hk_t, current_supply_d),
+	TM_FIELD(edc_hk_t, current_supply_a),
+	TM_FIELD(edc_hk_t, voltage_supply),
+	TM_FIELD(edc_hk_t, temp),
+	TM_FIELD(edc_hk_t, pll_sync_bit),
+	TM_FIELD(edc_hk_t, adc_rms),
+	TM_FIELD(edc_hk_t, num_rx_ptt),
+	TM_FIELD(edc_hk_t, max_parl_decod),
+	TM_FIELD(edc_hk_t, mem_err_count),
+};
+
+#define TM_FIELDS_COUNT(f) (sizeof(f) / sizeof((f)[0]))
+
+_Static_assert(TM_FIELDS_COUNT(tm_eps_fields) == TM_FIELDS_EPS,
+	       "TM_FIELDS_EPS does not match the EPS fields");
+_Static_assert(TM_FIELDS_COUNT(tm_ttc_fields) == TM_FIELDS_TTC,
+	       "TM_FIELDS_TTC does not match the TTC fields");
+_Static_assert(TM_FIELDS_COUNT(tm_edc_hk_fields) == TM_FIELDS_EDC_HK,
+	       "TM_FIELDS_EDC_HK does not match the EDC HK fields");
+
+const struct tm_field *tm_fields_get(enum tm_pub_type type,
+				     unsigned int *nfields, size_t *size)
+{
+	const struct tm_field *fields = NULL;
+	size_t len = 0U;
+
+	switch (type) {
+	case TM_PUB_EPS_DATA:
+		fields = tm_eps_fields;
+		*nfields = TM_FIELDS_EPS;
+		len = sizeof(sl_eps2_data_t);
+		break;
+	case TM_PUB_TTC_DATA:
+		fields = tm_ttc_fields;
+		*nfields = TM_FIELDS_TTC;
+		len = sizeof(sl_ttc2_hk_data_t);
+		break;
+	case TM_PUB_EDC_HK:
+		fields = tm_edc_hk_fields;
+		*nfields = TM_FIELDS_EDC_HK;
+		len = sizeof(edc_hk_t);
+		break;
+	default:
+		*nfields = 0U;
+		break;
+	}
+
+	if (size != NULL)
+		*size = len;
+
+	return fields;
+}
+
+int tm_fields_find(enum tm_pub_type type, const char *name)
+{
+	unsigned int nfields = 0U;
+	const struct tm_field *fields = tm_fields_get(type, &nfields, NULL);
+
+	for (unsigned int f = 0U; f < nfields; ++f) {
+		if (strcmp(fields[f].name, name) == 0)
+			return (int)f;
+	}
+
+	return -1;
+}
+
+int64_t tm_fields_load(const void *data, const struct tm_field *field)
+{
+	const uint8_t *p = (const uint8_t *)data + field->offset;
+
+	union {
+		uint8_t u8;
+		int8_t i8;
+		uint16_t u16;
+		int16_t i16;
+		uint32_t u32;
+		int32_t i32;
+	} v;
+
+	switch (field->kind) {
+	case TM_FIELD_U8:
+		memcpy(&v.u8, p, sizeof(v.u8));
+		return v.u8;
+	case TM_FIELD_I8:
+		memcpy(&v.i8, p, sizeof(v.i8));
+		return v.i8;
+	case TM_FIELD_U16:
+		memcpy(&v.u16, p, sizeof(v.u16));
+		return v.u16;
+	case TM_FIELD_I16:
+		memcpy(&v.i16, p, sizeof(v.i16));
+		return v.i16;
+	case TM_FIELD_U32:
+		memcpy(&v.u32, p, sizeof(v.u32));
+		return v.u32;
+	case TM_FIELD_I32:
+		memcpy(&v.i32, p, sizeof(v.i32));
+		return v.i32;
+	default:
+		return 0;
+	}
+}
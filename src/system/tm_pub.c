@@ -0,0 +1,195 @@
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zmq.h>
+
+#include <system/sys_log.h>
+#include <system/tm_pub.h>
+
+#define TM_PUB_MODULE_NAME "tm_pub"
+
+#define TM_PUB_BUF_SIZE (sizeof(struct tm_pub_hdr) + TM_PUB_PAYLOAD_MAX)
+
+struct tm_pub_buf {
+	alignas(8) uint8_t data[TM_PUB_BUF_SIZE];
+	struct tm_pub_buf *next;
+};
+
+static const char *const tm_pub_topics[TM_PUB_TYPE_COUNT] = {
+	[TM_PUB_EPS_DATA] = "eps", [TM_PUB_TTC_DATA] = "ttc",
+	[TM_PUB_EDC_HK] = "edc",   [TM_PUB_EDC_PTT] = "edc",
+	[TM_PUB_ORBIT] = "pos",
+};
+
+static struct tm_pub_buf pool[TM_PUB_POOL_SIZE];
+
+static struct tm_pub_buf *pool_free;
+
+/* Buffers are returned by ZMQ's I/O thread, hence the lock */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ZMQ sockets aren't thread safe */
+static pthread_mutex_t sock_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *zmq_ctx;
+
+static void *pub_sock;
+
+static atomic_bool pub_running;
+
+static atomic_ulong pub_dropped;
+
+static struct tm_pub_buf *tm_pub_buf_get(void)
+{
+	pthread_mutex_lock(&pool_lock);
+
+	struct tm_pub_buf *buf = pool_free;
+
+	if (buf != NULL)
+		pool_free = buf->next;
+
+	pthread_mutex_unlock(&pool_lock);
+
+	return buf;
+}
+
+static void tm_pub_buf_put(void *data, void *hint)
+{
+	(void)data;
+
+	struct tm_pub_buf *buf = hint;
+
+	pthread_mutex_lock(&pool_lock);
+
+	buf->next = pool_free;
+	pool_free = buf;
+
+	pthread_mutex_unlock(&pool_lock);
+}
+
+int tm_pub_init(const char *endpoint)
+{
+	int hwm = TM_PUB_POOL_SIZE;
+	int linger = 0;
+
+	if (atomic_load_explicit(&pub_running, memory_order_acquire))
+		return 0;
+
+	pool_free = NULL;
+
+	for (size_t i = 0U; i < TM_PUB_POOL_SIZE; ++i)
+		tm_pub_buf_put(pool[i].data, &pool[i]);
+
+	zmq_ctx = zmq_ctx_new();
+
+	if (zmq_ctx == NULL) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						TM_PUB_MODULE_NAME,
+						"Failed to create context: %s",
+						zmq_strerror(zmq_errno()));
+		return -1;
+	}
+
+	pub_sock = zmq_socket(zmq_ctx, ZMQ_PUB);
+
+	if ((pub_sock == NULL) ||
+	    (zmq_setsockopt(pub_sock, ZMQ_SNDHWM, &hwm, sizeof(hwm)) != 0) ||
+	    (zmq_setsockopt(pub_sock, ZMQ_LINGER, &linger, sizeof(linger)) !=
+	     0) ||
+	    (zmq_bind(pub_sock, endpoint) != 0)) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR,
+						TM_PUB_MODULE_NAME,
+						"Failed to bind %s: %s",
+						endpoint,
+						zmq_strerror(zmq_errno()));
+
+		if (pub_sock != NULL)
+			zmq_close(pub_sock);
+
+		zmq_ctx_term(zmq_ctx);
+		pub_sock = NULL;
+		zmq_ctx = NULL;
+
+		return -1;
+	}
+
+	atomic_store_explicit(&pub_running, true, memory_order_release);
+
+	sys_log_print_event_from_module(SYS_LOG_INFO, TM_PUB_MODULE_NAME,
+					"Publishing telemetry on %s", endpoint);
+
+	return 0;
+}
+
+void *tm_pub_get_context(void)
+{
+	if (!atomic_load_explicit(&pub_running, memory_order_acquire))
+		return NULL;
+
+	return zmq_ctx;
+}
+
+int tm_pub_send(enum tm_pub_type type, uint8_t instance, const void *data,
+		size_t size)
+{
+	if (!atomic_load_explicit(&pub_running, memory_order_acquire) ||
+	    (type >= TM_PUB_TYPE_COUNT) || (size > TM_PUB_PAYLOAD_MAX))
+		return -1;
+
+	struct tm_pub_buf *buf = tm_pub_buf_get();
+
+	if (buf == NULL) {
+		atomic_fetch_add_explicit(&pub_dropped, 1UL,
+					  memory_order_relaxed);
+		return -1;
+	}
+
+	struct tm_pub_hdr hdr = {
+		.version = TM_PUB_VERSION,
+		.type = (uint8_t)type,
+		.instance = instance,
+		.size = (uint32_t)size,
+		.timestamp = tm_pub_now_us(),
+	};
+
+	memcpy(buf->data, &hdr, sizeof(hdr));
+	memcpy(&buf->data[sizeof(hdr)], data, size);
+
+	zmq_msg_t msg;
+
+	/* ZMQ owns the buffer from here and returns it via tm_pub_buf_put() */
+	if (zmq_msg_init_data(&msg, buf->data, sizeof(hdr) + size,
+			      tm_pub_buf_put, buf) != 0) {
+		tm_pub_buf_put(buf->data, buf);
+		atomic_fetch_add_explicit(&pub_dropped, 1UL,
+					  memory_order_relaxed);
+		return -1;
+	}
+
+	const char *topic = tm_pub_topics[type];
+	int err = 0;
+
+	pthread_mutex_lock(&sock_lock);
+
+	if ((zmq_send_const(pub_sock, topic, strlen(topic),
+			    ZMQ_SNDMORE | ZMQ_DONTWAIT) < 0) ||
+	    (zmq_msg_send(&msg, pub_sock, ZMQ_DONTWAIT) < 0))
+		err = -1;
+
+	pthread_mutex_unlock(&sock_lock);
+
+	if (err != 0) {
+		zmq_msg_close(&msg);
+		atomic_fetch_add_explicit(&pub_dropped, 1UL,
+					  memory_order_relaxed);
+	}
+
+	return err;
+}
+
+unsigned long tm_pub_get_dropped(void)
+{
+	return atomic_load_explicit(&pub_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,123 @@
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <system/seqlock.h>
+#include <system/tm_shm.h>
+
+_Static_assert(TM_SHM_HDR_SIZE >= sizeof(struct tm_shm_hdr),
+	       "the header does not fit in TM_SHM_HDR_SIZE");
+_Static_assert((TM_SHM_HDR_SIZE % alignof(struct tm_shm_rec)) == 0U,
+	       "the records must stay cache line aligned");
+
+static const struct {
+	enum tm_pub_type type;
+	uint8_t instance;
+} tm_shm_devices[] = {
+	{ TM_PUB_EPS_DATA, 0U }, { TM_PUB_TTC_DATA, 0U },
+	{ TM_PUB_TTC_DATA, 1U }, { TM_PUB_EDC_HK, 0U },
+	{ TM_PUB_EDC_PTT, 0U },	 { TM_PUB_ORBIT, 0U },
+};
+
+#define TM_SHM_RECORDS (sizeof(tm_shm_devices) / sizeof(tm_shm_devices[0]))
+
+static _Atomic(struct tm_shm_rec *) shm_recs;
+
+static struct tm_shm_rec *tm_shm_find(enum tm_pub_type type, uint8_t instance)
+{
+	struct tm_shm_rec *recs =
+		atomic_load_explicit(&shm_recs, memory_order_acquire);
+
+	if (recs == NULL)
+		return NULL;
+
+	for (size_t i = 0U; i < TM_SHM_RECORDS; ++i) {
+		if ((tm_shm_devices[i].type == type) &&
+		    (tm_shm_devices[i].instance == instance))
+			return &recs[i];
+	}
+
+	return NULL;
+}
+
+int tm_shm_init(const char *name)
+{
+	size_t size = TM_SHM_HDR_SIZE +
+		      (TM_SHM_RECORDS * sizeof(struct tm_shm_rec));
+
+	if (atomic_load_explicit(&shm_recs, memory_order_acquire) != NULL)
+		return 0;
+
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+	if (fd < 0)
+		return -1;
+
+	if (ftruncate(fd, (off_t)size) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (map == MAP_FAILED)
+		return -1;
+
+	struct tm_shm_hdr *hdr = map;
+	struct tm_shm_rec *recs = (void *)((uint8_t *)map + TM_SHM_HDR_SIZE);
+
+	/*
+	 * Readers still mapping the segment of a previous run see its records
+	 * emptied, a write torn by its crash being closed first.
+	 */
+	for (size_t i = 0U; i < TM_SHM_RECORDS; ++i) {
+		if ((__atomic_load_n(&recs[i].seq, __ATOMIC_RELAXED) & 1U) != 0U)
+			seqlock_write_end(&recs[i].seq);
+
+		seqlock_write_begin(&recs[i].seq);
+
+		recs[i].type = (uint8_t)tm_shm_devices[i].type;
+		recs[i].instance = tm_shm_devices[i].instance;
+		recs[i].size = 0U;
+		recs[i].timestamp = 0U;
+
+		seqlock_write_end(&recs[i].seq);
+	}
+
+	hdr->version = TM_SHM_VERSION;
+	hdr->hdr_size = TM_SHM_HDR_SIZE;
+	hdr->rec_size = sizeof(struct tm_shm_rec);
+	hdr->records = TM_SHM_RECORDS;
+
+	__atomic_store_n(&hdr->magic, TM_SHM_MAGIC, __ATOMIC_RELEASE);
+
+	atomic_store_explicit(&shm_recs, recs, memory_order_release);
+
+	return 0;
+}
+
+int tm_shm_publish(enum tm_pub_type type, uint8_t instance, const void *data,
+		   size_t size)
+{
+	struct tm_shm_rec *rec = tm_shm_find(type, instance);
+
+	if ((rec == NULL) || (size > TM_PUB_PAYLOAD_MAX))
+		return -1;
+
+	uint64_t timestamp = tm_pub_now_us();
+
+	seqlock_write_begin(&rec->seq);
+
+	rec->timestamp = timestamp;
+	rec->size = (uint16_t)size;
+	memcpy(rec->data, data, size);
+
+	seqlock_write_end(&rec->seq);
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <system/seqlock.h>
+#include <system/tm_shm_reader.h>
+
+int tm_shm_reader_open(struct tm_shm_reader *reader, const char *name)
+{
+	struct stat st;
+
+	reader->hdr = NULL;
+	reader->size = 0U;
+
+	int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+
+	if (fd < 0)
+		return -1;
+
+	if ((fstat(fd, &st) != 0) ||
+	    ((size_t)st.st_size < sizeof(struct tm_shm_hdr))) {
+		close(fd);
+		return -1;
+	}
+
+	const struct tm_shm_hdr *hdr =
+		mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (hdr == MAP_FAILED)
+		return -1;
+
+	if ((__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != TM_SHM_MAGIC) ||
+	    (hdr->version != TM_SHM_VERSION) ||
+	    (hdr->rec_size != sizeof(struct tm_shm_rec)) ||
+	    ((hdr->hdr_size % alignof(struct tm_shm_rec)) != 0U) ||
+	    ((hdr->hdr_size + ((size_t)hdr->records * hdr->rec_size)) >
+	     (size_t)st.st_size)) {
+		munmap((void *)hdr, (size_t)st.st_size);
+		return -1;
+	}
+
+	reader->hdr = hdr;
+	reader->size = (size_t)st.st_size;
+
+	return 0;
+}
+
+long tm_shm_read(const struct tm_shm_reader *reader, enum tm_pub_type type,
+		 uint8_t instance, void *data, size_t size,
+		 uint64_t *timestamp)
+{
+	const struct tm_shm_rec *recs =
+		(const void *)((const uint8_t *)reader->hdr +
+			       reader->hdr->hdr_size);
+	const struct tm_shm_rec *rec = NULL;
+
+	/* The type and instance of a record never change once published */
+	for (uint32_t i = 0U; i < reader->hdr->records; ++i) {
+		if ((recs[i].type == (uint8_t)type) &&
+		    (recs[i].instance == instance)) {
+			rec = &recs[i];
+			break;
+		}
+	}
+
+	if (rec == NULL)
+		return -1;
+
+	for (unsigned int i = 0U; i < TM_SHM_READ_TRIES; ++i) {
+		uint32_t start = seqlock_read_begin(&rec->seq);
+		size_t len = rec->size;
+		uint64_t stamp = rec->timestamp;
+
+		/* A torn size is caught by the retry, but must not overflow */
+		if ((len <= size) && (len <= TM_PUB_PAYLOAD_MAX))
+			memcpy(data, rec->data, len);
+
+		if (seqlock_read_retry(&rec->seq, start))
+			continue;
+
+		if (len > size)
+			return -1;
+
+		if (timestamp != NULL)
+			*timestamp = stamp;
+
+		return (long)len;
+	}
+
+	return -1;
+}
+
+void tm_shm_reader_close(struct tm_shm_reader *reader)
+{
+	if (reader->hdr != NULL)
+		munmap((void *)reader->hdr, reader->size);
+
+	reader->hdr = NULL;
+	reader->size = 0U;
+}
@@ -0,0 +1,231 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <system/tm_fields.h>
+#include <system/tm_store.h>
+
+#define TM_STORE_MASK (TM_STORE_CAPACITY - 1U)
+
+struct tm_store_series {
+	enum tm_pub_type type;
+	uint8_t instance;
+	int64_t (*cols)[TM_STORE_CAPACITY];
+	uint64_t ts[TM_STORE_CAPACITY];
+	unsigned long count; /* Samples appended, the last ones are kept */
+	pthread_rwlock_t lock;
+};
+
+static int64_t tm_store_eps_cols[TM_FIELDS_EPS][TM_STORE_CAPACITY];
+static int64_t tm_store_ttc_0_cols[TM_FIELDS_TTC][TM_STORE_CAPACITY];
+static int64_t tm_store_ttc_1_cols[TM_FIELDS_TTC][TM_STORE_CAPACITY];
+static int64_t tm_store_edc_hk_cols[TM_FIELDS_EDC_HK][TM_STORE_CAPACITY];
+
+#define TM_STORE_SERIES(t, i, c)                                               \
+	{                                                                      \
+		.type = (t), .instance = (i), .cols = (c),                     \
+		.lock = PTHREAD_RWLOCK_INITIALIZER,                            \
+	}
+
+static struct tm_store_series tm_store_series[] = {
+	TM_STORE_SERIES(TM_PUB_EPS_DATA, 0U, tm_store_eps_cols),
+	TM_STORE_SERIES(TM_PUB_TTC_DATA, 0U, tm_store_ttc_0_cols),
+	TM_STORE_SERIES(TM_PUB_TTC_DATA, 1U, tm_store_ttc_1_cols),
+	TM_STORE_SERIES(TM_PUB_EDC_HK, 0U, tm_store_edc_hk_cols),
+};
+
+static struct tm_store_series *tm_store_find(enum tm_pub_type type,
+					     uint8_t instance)
+{
+	for (size_t i = 0U;
+	     i < (sizeof(tm_store_series) / sizeof(tm_store_series[0])); ++i) {
+		if ((tm_store_series[i].type == type) &&
+		    (tm_store_series[i].instance == instance))
+			return &tm_store_series[i];
+	}
+
+	return NULL;
+}
+
+int tm_store_append(enum tm_pub_type type, uint8_t instance, const void *data,
+		    size_t size)
+{
+	struct tm_store_series *s = tm_store_find(type, instance);
+	unsigned int nfields = 0U;
+	size_t len = 0U;
+	const struct tm_field *fields = tm_fields_get(type, &nfields, &len);
+
+	if ((s == NULL) || (size != len))
+		return -1;
+
+	uint64_t timestamp = tm_pub_now_us();
+
+	pthread_rwlock_wrlock(&s->lock);
+
+	unsigned int slot = (unsigned int)(s->count & TM_STORE_MASK);
+
+	/* The windows are binary searched, the clock may be set back */
+	if ((s->count > 0U) &&
+	    (timestamp < s->ts[(s->count - 1U) & TM_STORE_MASK]))
+		timestamp = s->ts[(s->count - 1U) & TM_STORE_MASK];
+
+	s->ts[slot] = timestamp;
+
+	for (unsigned int f = 0U; f < nfields; ++f)
+		s->cols[f][slot] = tm_fields_load(data, &fields[f]);
+
+	s->count++;
+
+	pthread_rwlock_unlock(&s->lock);
+
+	return 0;
+}
+
+int tm_store_field(enum tm_pub_type type, const char *name)
+{
+	return tm_fields_find(type, name);
+}
+
+static bool tm_store_valid(const struct tm_store_series *s, int field)
+{
+	unsigned int nfields = 0U;
+
+	(void)tm_fields_get(s->type, &nfields, NULL);
+
+	return (field >= 0) && ((unsigned int)field < nfields);
+}
+
+/*
+ * Finds the samples in [from, to], as a range [*first, *last) of sample
+ * numbers, the slot of a sample being its number masked. Called with the
+ * lock held.
+ */
+static void tm_store_window(const struct tm_store_series *s, uint64_t from,
+			    uint64_t to, unsigned long *first,
+			    unsigned long *last)
+{
+	size_t len = (s->count < TM_STORE_CAPACITY) ? s->count :
+						      TM_STORE_CAPACITY;
+	unsigned long oldest = s->count - len;
+	size_t lo = 0U;
+	size_t hi = len;
+
+	/* First sample at or after from */
+	while (lo < hi) {
+		size_t mid = lo + ((hi - lo) / 2U);
+
+		if (s->ts[(oldest + mid) & TM_STORE_MASK] < from)
+			lo = mid + 1U;
+		else
+			hi = mid;
+	}
+
+	*first = oldest + lo;
+	hi = len;
+
+	/* First sample after to */
+	while (lo < hi) {
+		size_t mid = lo + ((hi - lo) / 2U);
+
+		if (s->ts[(oldest + mid) & TM_STORE_MASK] <= to)
+			lo = mid + 1U;
+		else
+			hi = mid;
+	}
+
+	*last = oldest + lo;
+}
+
+long tm_store_scan(enum tm_pub_type type, uint8_t instance, int field,
+		   uint64_t from, uint64_t to, uint64_t from_number,
+		   uint64_t *number, uint64_t *timestamp, int64_t *val,
+		   size_t max)
+{
+	struct tm_store_series *s = tm_store_find(type, instance);
+	unsigned long first = 0UL;
+	unsigned long last = 0UL;
+
+	if ((s == NULL) || !tm_store_valid(s, field))
+		return -1;
+
+	pthread_rwlock_rdlock(&s->lock);
+
+	tm_store_window(s, from, to, &first, &last);
+
+	/* The previous pages of a scan */
+	if (from_number > first)
+		first = (from_number < last) ? (unsigned long)from_number :
+					       last;
+
+	size_t n = ((last - first) < max) ? (last - first) : max;
+
+	for (size_t i = 0U; i < n; ++i) {
+		unsigned int slot = (unsigned int)((first + i) & TM_STORE_MASK);
+
+		if (number != NULL)
+			number[i] = first + i;
+
+		if (timestamp != NULL)
+			timestamp[i] = s->ts[slot];
+
+		val[i] = s->cols[field][slot];
+	}
+
+	pthread_rwlock_unlock(&s->lock);
+
+	return (long)n;
+}
+
+int tm_store_aggregate(enum tm_pub_type type, uint8_t instance, int field,
+		       uint64_t from, uint64_t to, struct tm_store_agg *agg)
+{
+	struct tm_store_series *s = tm_store_find(type, instance);
+	unsigned long first = 0UL;
+	unsigned long last = 0UL;
+
+	if ((s == NULL) || !tm_store_valid(s, field))
+		return -1;
+
+	memset(agg, 0, sizeof(*agg));
+
+	pthread_rwlock_rdlock(&s->lock);
+
+	tm_store_window(s, from, to, &first, &last);
+
+	if (last > first) {
+		const int64_t *col = s->cols[field];
+		unsigned int start = (unsigned int)(first & TM_STORE_MASK);
+		size_t n = last - first;
+		int64_t min = col[start];
+		int64_t max = col[start];
+		int64_t sum = 0;
+
+		/* At most two runs of contiguous values, split by the wrap */
+		while (n > 0U) {
+			size_t run = TM_STORE_CAPACITY - start;
+
+			if (run > n)
+				run = n;
+
+			for (size_t i = start; i < (start + run); ++i) {
+				min = (col[i] < min) ? col[i] : min;
+				max = (col[i] > max) ? col[i] : max;
+				sum += col[i];
+			}
+
+			n -= run;
+			start = 0U;
+		}
+
+		agg->count = last - first;
+		agg->min = min;
+		agg->max = max;
+		agg->mean = (double)sum / (double)agg->count;
+	}
+
+	pthread_rwlock_unlock(&s->lock);
+
+	return 0;
+}
@@ -1,75 +1,71 @@
-#include <pthread.h>
-
-#include <system/context.h>
+#include <system/blackboard.h>
+#include <system/evloop.h>
 #include <system/sys_log.h>
 
 #include <devices/eps.h>
 #include <drivers/sl_eps2.h>
 
-void *control_heater_thread(void *arg)
+static int control_heater_step(struct evloop_task *task)
 {
-	struct obdh_sim_ctx *ctx = arg;
-	struct timespec next = { 0 };
-
-	clock_gettime(CLOCK_MONOTONIC, &next);
+	if (blackboard_get_eclipsed()) {
+		sys_log_print_event_from_module(
+			SYS_LOG_INFO, "heater",
+			"Satellite is eclipsed! Enabling heaters...");
 
-	for (;;) {
-		next.tv_sec += 10;
-
-		if (ctx->cond.eclipsed) {
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_MODE,
+				  SL_EPS2_HEATER_MODE_MANUAL) < 0) {
 			sys_log_print_event_from_module(
-				SYS_LOG_INFO, "heater",
-				"Satellite is eclipsed! Enabling heaters...");
-
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_MODE,
-					  SL_EPS2_HEATER_MODE_MANUAL) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 1 to manual!");
-			}
-
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_MODE,
-					  SL_EPS2_HEATER_MODE_MANUAL) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 2 to manual!");
-			}
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 1 to manual!");
+		}
 
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
-					  50U) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 1 duty to 50%!");
-			}
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_MODE,
+				  SL_EPS2_HEATER_MODE_MANUAL) < 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 2 to manual!");
+		}
 
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
-					  50U) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 2 duty to 50%!");
-			}
-		} else {
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
+				  50U) < 0) {
 			sys_log_print_event_from_module(
-				SYS_LOG_INFO, "heater",
-				"Satellite is not eclipsed! Disabling heaters...");
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 1 duty to 50%%!");
+		}
 
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
-					  0U) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 1 duty to 0%!");
-			}
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
+				  50U) < 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 2 duty to 50%%!");
+		}
+	} else {
+		sys_log_print_event_from_module(
+			SYS_LOG_INFO, "heater",
+			"Satellite is not eclipsed! Disabling heaters...");
 
-			if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
-					  0U) < 0) {
-				sys_log_print_event_from_module(
-					SYS_LOG_ERROR, "heater",
-					"Failed to set Heater 2 duty to 0%!");
-			}
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_1_DUTY_CYCLE,
+				  0U) < 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 1 duty to 0%%!");
 		}
 
-		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
-	};
+		if (eps_set_param(SL_EPS2_REG_BAT_HEATER_2_DUTY_CYCLE,
+				  0U) < 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, "heater",
+				"Failed to set Heater 2 duty to 0%%!");
+		}
+	}
 
-	return NULL;
+	return EVLOOP_TASK_DONE;
 }
+
+struct evloop_task control_heater_task = {
+	.name = "heater",
+	.period_ms = 10000U,
+	.deadline_ms = 1000U,
+	.prio = 1U,
+	.step = control_heater_step,
+};
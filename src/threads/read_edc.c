@@ -1,9 +1,16 @@
-#include <pthread.h>
 #include <math.h>
+#include <stdbool.h>
 
 #include <libmop/payload.h>
+#include <libmop/pl_errno.h>
 
+#include <system/evloop.h>
+#include <system/ptt_queue.h>
 #include <system/sys_log.h>
+#include <system/tm_archive.h>
+#include <system/tm_pub.h>
+#include <system/tm_shm.h>
+#include <system/tm_store.h>
 #include <devices/payload.h>
 #include <drivers/edc.h>
 #include <time.h>
@@ -56,38 +63,92 @@ static void edc_print_ptt(struct payload *edc, edc_ptt_t *ptt)
 					ptt->carrier_freq);
 }
 
-void *read_edc_thread(void *arg)
+/* The PTT FIFO is drained at each period, the HK read every few periods */
+#define READ_EDC_PERIOD_MS 5000U
+#define READ_EDC_HK_PERIODS 12U
+
+/* Minimum gap between a command and the next, as for edc_timing */
+#define READ_EDC_CMD_GAP_MS 10
+
+/* Packets drained per period, a full FIFO, the rest wait for the next one */
+#define READ_EDC_PTT_MAX 64U
+
+enum read_edc_state {
+	READ_EDC_START,
+	READ_EDC_HK,
+	READ_EDC_STATE,
+	READ_EDC_PTT,
+};
+
+/*
+ * Reads the state, then moves on to the PTT packets it counts unless the
+ * period's share was drained. Returns the result of the step.
+ */
+static int read_edc_state(struct evloop_task *task, struct payload *edc,
+			  edc_state_t *state, unsigned int drained)
 {
-	(void)arg;
-
-	struct timespec next = { 0 };
-	struct payload edc = { 0 };
-	struct payload_ctx edc_ctx = { 0 };
-	edc_config_t edc_conf;
-	edc_hk_t hk;
-	edc_state_t state;
-	edc_ptt_t ptt;
-
-	if (payload_edc_init(1U, &edc, &edc_conf, &edc_ctx) != 0) {
-		sys_log_print_event_from_module(
-			SYS_LOG_ERROR, "edc",
-			"Failed to initialize EDC context!");
+	if (payload_read_data(edc, EDC_FRAME_ID_STATE, (uint8_t *)state,
+			      sizeof(*state)) != 0) {
+		sys_log_print_event_from_module(SYS_LOG_ERROR, edc->name,
+						"Error reading state!");
+		return EVLOOP_TASK_DONE;
 	}
 
-	if (payload_init(&edc) != 0) {
-		sys_log_print_event_from_module(
-			SYS_LOG_ERROR, "edc",
-			"Failed to initialize EDC payload!");
-	}
+	if (drained == 0U)
+		edc_print_state(edc, state);
+
+	if ((state->ptt_available == 0U) || (drained >= READ_EDC_PTT_MAX))
+		return EVLOOP_TASK_DONE;
+
+	task->iter = 0U;
+	task->state = READ_EDC_PTT;
+
+	return READ_EDC_CMD_GAP_MS;
+}
+
+static int read_edc_step(struct evloop_task *task)
+{
+	static struct payload edc = { 0 };
+	static struct payload_ctx edc_ctx = { 0 };
+	static edc_config_t edc_conf;
+	static bool edc_ready = false;
+	static edc_hk_t hk;
+	static edc_state_t state;
+	static edc_ptt_t ptt;
+	static unsigned int cycles = 0U;
+	static unsigned int drained;
+	int err;
+
+	switch (task->state) {
+	case READ_EDC_START: {
+		if (!edc_ready) {
+			if (payload_edc_init(1U, &edc, &edc_conf, &edc_ctx) !=
+			    0) {
+				sys_log_print_event_from_module(
+					SYS_LOG_ERROR, "edc",
+					"Failed to initialize EDC context!");
+			}
 
-	clock_gettime(CLOCK_MONOTONIC, &next);
+			if (payload_init(&edc) != 0) {
+				sys_log_print_event_from_module(
+					SYS_LOG_ERROR, "edc",
+					"Failed to initialize EDC payload!");
+			}
+
+			edc_ready = true;
+		}
+
+		drained = 0U;
 
-	for (;;) {
-		next.tv_sec += 60;
+		if ((cycles++ % READ_EDC_HK_PERIODS) != 0U)
+			return read_edc_state(task, &edc, &state, drained);
+
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
 
 		struct payload_timestamp ts = {
-			.tv_sec = next.tv_sec - 60U,
-			.tv_nsec = next.tv_nsec,
+			.tv_sec = now.tv_sec,
+			.tv_nsec = now.tv_nsec,
 		};
 
 		if (payload_set_clock(&edc, &ts) != 0) {
@@ -103,44 +164,79 @@ void *read_edc_thread(void *arg)
 				"Failed to resume ptt task!");
 		}
 
-		edc_delay_ms(50U);
+		task->state = READ_EDC_HK;
 
+		return 50;
+	}
+	case READ_EDC_HK:
 		if (payload_read_data(&edc, EDC_FRAME_ID_HK, (uint8_t *)&hk,
 				      sizeof(hk)) == 0) {
+			tm_pub_send(TM_PUB_EDC_HK, 0U, &hk, sizeof(hk));
+			tm_shm_publish(TM_PUB_EDC_HK, 0U, &hk, sizeof(hk));
+			tm_store_append(TM_PUB_EDC_HK, 0U, &hk, sizeof(hk));
+			tm_archive_append(TM_PUB_EDC_HK, 0U, &hk, sizeof(hk));
 			edc_print_hk(&edc, &hk);
 		} else {
 			sys_log_print_event_from_module(SYS_LOG_ERROR, edc.name,
 							"Failed to read hk!");
 		}
 
-		edc_delay_ms(500U);
-
-		if (payload_read_data(&edc, EDC_FRAME_ID_STATE,
-				      (uint8_t *)&state, sizeof(state)) == 0) {
-			edc_print_state(&edc, &state);
-
-			if (state.ptt_available > 0) {
-				for (uint8_t i = 0; i < state.ptt_available;
-				     i++) {
-					if (payload_read_data(
-						    &edc, EDC_FRAME_ID_PTT,
-						    (uint8_t *)&ptt,
-						    sizeof(ptt)) == 0) {
-						edc_print_ptt(&edc, &ptt);
-					} else {
-						sys_log_print_event_from_module(
-							SYS_LOG_ERROR, edc.name,
-							"Error reading ptt package!");
-					}
-
-					edc_delay_ms(500U);
-				}
-			}
-		} else {
-			sys_log_print_event_from_module(SYS_LOG_ERROR, edc.name,
-							"Error reading state!");
+		task->state = READ_EDC_STATE;
+
+		return READ_EDC_CMD_GAP_MS;
+	case READ_EDC_STATE:
+		return read_edc_state(task, &edc, &state, drained);
+	case READ_EDC_PTT:
+		/* The read pops the packet from the FIFO once decoded */
+		err = payload_read_data(&edc, EDC_FRAME_ID_PTT, (uint8_t *)&ptt,
+					sizeof(ptt));
+
+		/* The last packet was still there, the next one waits */
+		if (err == -PL_ERRNO_TIMEOUT) {
+			sys_log_print_event_from_module(
+				SYS_LOG_WARNING, edc.name,
+				"PTT package not refreshed, left for the next period!");
+			break;
 		}
 
-		return NULL;
+		if (err != 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_ERROR, edc.name,
+				"Error reading ptt package!");
+			break;
+		}
+
+		if (ptt_queue_push(&ptt) != 0) {
+			sys_log_print_event_from_module(
+				SYS_LOG_WARNING, edc.name,
+				"PTT queue full, oldest package dropped!");
+		}
+
+		tm_pub_send(TM_PUB_EDC_PTT, 0U, &ptt, sizeof(ptt));
+		tm_shm_publish(TM_PUB_EDC_PTT, 0U, &ptt, sizeof(ptt));
+		edc_print_ptt(&edc, &ptt);
+
+		if (++drained >= READ_EDC_PTT_MAX)
+			break;
+
+		/*
+		 * Once the packets counted by the state are drained, the
+		 * state is read again for those that arrived meanwhile.
+		 */
+		if (++task->iter >= state.ptt_available)
+			task->state = READ_EDC_STATE;
+
+		return READ_EDC_CMD_GAP_MS;
+	default:
+		break;
 	}
+
+	return EVLOOP_TASK_DONE;
 }
+
+struct evloop_task read_edc_task = {
+	.name = "edc",
+	.period_ms = READ_EDC_PERIOD_MS,
+	.prio = 4U,
+	.step = read_edc_step,
+};
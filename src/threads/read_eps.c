@@ -1,57 +1,74 @@
-#include <pthread.h>
-
+#include <system/blackboard.h>
+#include <system/evloop.h>
 #include <system/sys_log.h>
+#include <system/tm_archive.h>
+#include <system/tm_pub.h>
+#include <system/tm_shm.h>
+#include <system/tm_store.h>
 #include <devices/eps.h>
-#include <drivers/sl_eps2.h>
 
 #define READ_EPS_MAX_RETRIES 5U
 
-void *read_eps_thread(void *arg)
-{
-	(void)arg;
-
-	struct timespec next = { 0 };
-	eps_data_t eps_data;
-
-	clock_gettime(CLOCK_MONOTONIC, &next);
-
-	for (;;) {
-		next.tv_sec += 60;
-
-		int8_t err = 0;
-		uint8_t retry_count = READ_EPS_MAX_RETRIES;
+#define READ_EPS_RETRY_DELAY_MS 100
 
-		do {
-			err = eps_init();
+enum read_eps_state {
+	READ_EPS_INIT,
+	READ_EPS_READ,
+};
 
-			if (err != 0) {
-				retry_count--;
-				sl_eps2_delay_ms(100U);
-			}
-		} while ((err != 0) && (retry_count > 0U));
+static int read_eps_step(struct evloop_task *task)
+{
+	static eps_data_t eps_data;
 
-		if (retry_count == 0U) {
+	switch (task->state) {
+	case READ_EPS_INIT:
+		/* Retried on the next cycle, after the EPS health backoff */
+		if (eps_init() != 0) {
 			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "eps",
-				"Max retries reached trying to initialize EPS!!!");
+				SYS_LOG_ERROR, "eps", "Failed to initialize EPS!");
+			break;
 		}
 
-		err = 0;
-		retry_count = READ_EPS_MAX_RETRIES;
-
-		do {
-			err = eps_get_data(&eps_data);
-
-			if (err != 0) {
-				retry_count--;
-				sl_eps2_delay_ms(100U);
-			}
-		} while ((err != 0) && (retry_count > 0U));
+		task->state = READ_EPS_READ;
+		task->iter = 0U;
+		/* fall through */
+	case READ_EPS_READ:
+		if (eps_get_data(&eps_data) != 0) {
+			if (++task->iter < READ_EPS_MAX_RETRIES)
+				return READ_EPS_RETRY_DELAY_MS;
+		} else {
+			tm_pub_send(TM_PUB_EPS_DATA, 0U, &eps_data,
+				    sizeof(eps_data));
+			tm_shm_publish(TM_PUB_EPS_DATA, 0U, &eps_data,
+				       sizeof(eps_data));
+			tm_store_append(TM_PUB_EPS_DATA, 0U, &eps_data,
+					sizeof(eps_data));
+			tm_archive_append(TM_PUB_EPS_DATA, 0U, &eps_data,
+					  sizeof(eps_data));
+
+			struct blackboard_battery battery = {
+				.voltage = eps_data.battery_voltage,
+				.current = eps_data.battery_current,
+				.charge = eps_data.battery_charge,
+				.temperature =
+					eps_data.battery_monitor_temperature,
+			};
+
+			blackboard_set_battery(&battery);
+		}
 
 		eps_print_data(&eps_data);
-
-		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+		break;
+	default:
+		break;
 	}
 
-	return NULL;
+	return EVLOOP_TASK_DONE;
 }
+
+struct evloop_task read_eps_task = {
+	.name = "eps",
+	.period_ms = 60000U,
+	.prio = 2U,
+	.step = read_eps_step,
+};
@@ -1,65 +1,84 @@
-#include <pthread.h>
-
+#include <system/evloop.h>
 #include <system/sys_log.h>
+#include <system/tm_archive.h>
+#include <system/tm_pub.h>
+#include <system/tm_shm.h>
+#include <system/tm_store.h>
 #include <devices/ttc.h>
 #include <devices/ttc_data.h>
 
-void *read_ttc_thread(void *arg)
+static int read_ttc_step(struct evloop_task *task)
 {
-	(void)arg;
-
-	struct timespec next = { 0 };
-	ttc_data_t ttc0_data;
-	ttc_data_t ttc1_data;
+	(void)task;
 
-	clock_gettime(CLOCK_MONOTONIC, &next);
+	ttc_data_t ttc_data[TTC_COUNT];
+	int err[TTC_COUNT];
 
-	for (;;) {
-		next.tv_sec += 60;
+	if (ttc_init(TTC_0) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error initializing the TTC device!");
+	}
 
-		if (ttc_init(TTC_0) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error initializing the TTC device!");
-		}
+	if (ttc_init(TTC_1) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error initializing the TTC device!");
+	}
 
-		if (ttc_init(TTC_1) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error initializing the TTC device!");
-		}
+	(void)ttc_get_data_all(ttc_data, err);
 
-		if (ttc_get_data(TTC_0, &ttc0_data) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error reading data from the TTC 0 device!");
-		} else {
-			ttc_print_data(TTC_0, &ttc0_data);
-		}
+	if (err[TTC_0] != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error reading data from the TTC 0 device!");
+	} else {
+		tm_pub_send(TM_PUB_TTC_DATA, TTC_0, &ttc_data[TTC_0],
+			    sizeof(ttc_data[TTC_0]));
+		tm_shm_publish(TM_PUB_TTC_DATA, TTC_0, &ttc_data[TTC_0],
+			       sizeof(ttc_data[TTC_0]));
+		tm_store_append(TM_PUB_TTC_DATA, TTC_0, &ttc_data[TTC_0],
+				sizeof(ttc_data[TTC_0]));
+		tm_archive_append(TM_PUB_TTC_DATA, TTC_0, &ttc_data[TTC_0],
+				  sizeof(ttc_data[TTC_0]));
+		ttc_print_data(TTC_0, &ttc_data[TTC_0]);
+	}
 
-		if (ttc_get_data(TTC_1, &ttc1_data) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error reading data from the TTC 1 device!");
-		} else {
-			ttc_print_data(TTC_1, &ttc1_data);
-		}
+	if (err[TTC_1] != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error reading data from the TTC 1 device!");
+	} else {
+		tm_pub_send(TM_PUB_TTC_DATA, TTC_1, &ttc_data[TTC_1],
+			    sizeof(ttc_data[TTC_1]));
+		tm_shm_publish(TM_PUB_TTC_DATA, TTC_1, &ttc_data[TTC_1],
+			       sizeof(ttc_data[TTC_1]));
+		tm_store_append(TM_PUB_TTC_DATA, TTC_1, &ttc_data[TTC_1],
+				sizeof(ttc_data[TTC_1]));
+		tm_archive_append(TM_PUB_TTC_DATA, TTC_1, &ttc_data[TTC_1],
+				  sizeof(ttc_data[TTC_1]));
+		ttc_print_data(TTC_1, &ttc_data[TTC_1]);
+	}
 
-		/* Checks if there was too many decoding errors on TTC */
-		if (ttc_check_failed_pkts(TTC_0) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error checking for decode errors from TTC 0 device!");
-		}
+	/* Checks if there was too many decoding errors on TTC */
+	if (ttc_check_failed_pkts(TTC_0) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error checking for decode errors from TTC 0 device!");
+	}
 
-		if (ttc_check_failed_pkts(TTC_1) != 0) {
-			sys_log_print_event_from_module(
-				SYS_LOG_ERROR, "ReadTTC",
-				"Error checking for decode errors from TTC 1 device!");
-		}
+	if (ttc_check_failed_pkts(TTC_1) != 0) {
+		sys_log_print_event_from_module(
+			SYS_LOG_ERROR, "ReadTTC",
+			"Error checking for decode errors from TTC 1 device!");
+	}
 
-		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
-	};
-
-	return NULL;
+	return EVLOOP_TASK_DONE;
 }
+
+struct evloop_task read_ttc_task = {
+	.name = "ttc",
+	.period_ms = 60000U,
+	.prio = 3U,
+	.step = read_ttc_step,
+};
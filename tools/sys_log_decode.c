@@ -0,0 +1,377 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <system/sys_log_bin.h>
+
+/*
+ * Offline decoder for the binary sys_log format. Renders every record the
+ * same way the text backend would have written it.
+ */
+
+struct fmt_def {
+	char *module;
+	char *format;
+	uint8_t nargs;
+	uint8_t types[SYS_LOG_BIN_MAX_ARGS];
+};
+
+static struct fmt_def defs[UINT16_MAX + 1U];
+
+static const char *log_level_strings[] = { "E", "W", "I" };
+
+static const char *level_str(uint8_t level)
+{
+	if (level < (sizeof(log_level_strings) / sizeof(log_level_strings[0])))
+		return log_level_strings[level];
+
+	return "?";
+}
+
+static void print_header(uint64_t stamp, uint8_t level, const char *module)
+{
+	printf("%lu.%03lu %s %s: ", (unsigned long)(stamp / 1000000U),
+	       (unsigned long)(stamp % 1000000U), level_str(level), module);
+}
+
+/* Prints literal text, collapsing "%%" */
+static void print_literal(const char *s, size_t len)
+{
+	for (size_t i = 0U; i < len; ++i) {
+		putchar(s[i]);
+
+		if ((s[i] == '%') && ((i + 1U) < len) && (s[i + 1U] == '%'))
+			i++;
+	}
+}
+
+#define PRINT_CONV(spec, stars, nstar, value)                              \
+	do {                                                               \
+		if ((nstar) == 0U)                                         \
+			printf(spec, value);                               \
+		else if ((nstar) == 1U)                                    \
+			printf(spec, (stars)[0], value);                   \
+		else                                                       \
+			printf(spec, (stars)[0], (stars)[1], value);       \
+	} while (0)
+
+static int print_conv(const struct sys_log_bin_conv *conv, const int *stars,
+		      const uint8_t **p, const uint8_t *end)
+{
+	char spec[64];
+	size_t n = 0U;
+
+	/* Rebuild the spec with a length modifier matching the stored width */
+	for (uint8_t i = 0U; (i < (conv->len - 1U)) && (n < (sizeof(spec) - 4U));
+	     ++i) {
+		if (strchr("hlLqjzt", conv->start[i]) == NULL)
+			spec[n++] = conv->start[i];
+	}
+
+	if ((conv->type == SYS_LOG_BIN_ARG_LONG) ||
+	    (conv->type == SYS_LOG_BIN_ARG_LLONG) ||
+	    (conv->type == SYS_LOG_BIN_ARG_SIZE)) {
+		spec[n++] = 'l';
+		spec[n++] = 'l';
+	}
+
+	spec[n++] = conv->start[conv->len - 1U];
+	spec[n] = '\0';
+
+	size_t size = sys_log_bin_arg_size(conv->type);
+
+	if (conv->type == SYS_LOG_BIN_ARG_STR)
+		size = (*p < end) ? (1U + **p) : 1U;
+
+	if ((size_t)(end - *p) < size)
+		return -1;
+
+	int32_t i32;
+	int64_t i64;
+	double f64;
+	char str[UINT8_MAX + 1U];
+
+	switch (conv->type) {
+	case SYS_LOG_BIN_ARG_INT:
+		memcpy(&i32, *p, sizeof(i32));
+		PRINT_CONV(spec, stars, conv->star, (int)i32);
+		break;
+	case SYS_LOG_BIN_ARG_PTR:
+		memcpy(&i64, *p, sizeof(i64));
+		PRINT_CONV(spec, stars, conv->star, (void *)(uintptr_t)i64);
+		break;
+	case SYS_LOG_BIN_ARG_DOUBLE:
+		memcpy(&f64, *p, sizeof(f64));
+		PRINT_CONV(spec, stars, conv->star, f64);
+		break;
+	case SYS_LOG_BIN_ARG_STR:
+		memcpy(str, *p + 1, size - 1U);
+		str[size - 1U] = '\0';
+		PRINT_CONV(spec, stars, conv->star, str);
+		break;
+	default:
+		memcpy(&i64, *p, sizeof(i64));
+		PRINT_CONV(spec, stars, conv->star, (long long)i64);
+		break;
+	}
+
+	*p += size;
+
+	return 0;
+}
+
+static void decode_event(const uint8_t *rec, size_t len, uint8_t level)
+{
+	const uint8_t *p = rec + sizeof(struct sys_log_bin_hdr);
+	const uint8_t *end = rec + len;
+	uint16_t id;
+	uint64_t stamp;
+
+	if (len < (sizeof(struct sys_log_bin_hdr) + 10U))
+		return;
+
+	memcpy(&id, p, sizeof(id));
+	memcpy(&stamp, p + 2, sizeof(stamp));
+	p += 10;
+
+	const struct fmt_def *def = &defs[id];
+
+	if (def->format == NULL) {
+		print_header(stamp, level, "?");
+		printf("<unknown format %u>\n", id);
+		return;
+	}
+
+	print_header(stamp, level, def->module);
+
+	struct sys_log_bin_conv conv;
+	const char *fmt = def->format;
+	const char *next;
+
+	while ((next = sys_log_bin_next_conv(fmt, &conv)) != NULL) {
+		int stars[2] = { 0, 0 };
+
+		print_literal(fmt, (size_t)(conv.start - fmt));
+
+		for (uint8_t i = 0U; i < conv.star; ++i) {
+			if ((end - p) < 4)
+				break;
+
+			memcpy(&stars[i], p, sizeof(int32_t));
+			p += 4;
+		}
+
+		if (print_conv(&conv, stars, &p, end) < 0) {
+			printf("<truncated>");
+			break;
+		}
+
+		fmt = next;
+	}
+
+	if (next == NULL)
+		print_literal(fmt, strlen(fmt));
+
+	putchar('\n');
+}
+
+static void decode_fmt(const uint8_t *rec, size_t len)
+{
+	const uint8_t *p = rec + sizeof(struct sys_log_bin_hdr);
+	uint16_t id;
+	uint16_t fmt_len;
+	uint8_t nargs;
+	uint8_t mod_len;
+
+	if (len < (sizeof(struct sys_log_bin_hdr) + 6U))
+		return;
+
+	memcpy(&id, p, sizeof(id));
+	nargs = p[2];
+	mod_len = p[3];
+	memcpy(&fmt_len, p + 4, sizeof(fmt_len));
+	p += 6;
+
+	if ((nargs > SYS_LOG_BIN_MAX_ARGS) ||
+	    (len < (sizeof(struct sys_log_bin_hdr) + 6U + nargs + mod_len +
+		    fmt_len)))
+		return;
+
+	struct fmt_def *def = &defs[id];
+
+	free(def->module);
+	free(def->format);
+
+	def->nargs = nargs;
+	memcpy(def->types, p, nargs);
+	p += nargs;
+
+	def->module = strndup((const char *)p, mod_len);
+	p += mod_len;
+
+	def->format = strndup((const char *)p, fmt_len);
+}
+
+static void decode_text(const uint8_t *rec, size_t len, uint8_t level)
+{
+	const uint8_t *p = rec + sizeof(struct sys_log_bin_hdr);
+	uint64_t stamp;
+	uint8_t mod_len;
+
+	if (len < (sizeof(struct sys_log_bin_hdr) + 9U))
+		return;
+
+	memcpy(&stamp, p, sizeof(stamp));
+	mod_len = p[8];
+	p += 9;
+
+	if ((size_t)(rec + len - p) < mod_len)
+		return;
+
+	/* Module-less messages are printed bare, like sys_log_print_msg() */
+	if (mod_len > 0U) {
+		printf("%lu.%03lu %s %.*s: ", (unsigned long)(stamp / 1000000U),
+		       (unsigned long)(stamp % 1000000U), level_str(level),
+		       (int)mod_len, (const char *)p);
+	}
+
+	p += mod_len;
+
+	printf("%.*s\n", (int)(rec + len - p), (const char *)p);
+}
+
+static int decode_session(const uint8_t *rec, size_t len)
+{
+	uint32_t magic;
+	uint16_t version;
+
+	if (len < (sizeof(struct sys_log_bin_hdr) + 6U))
+		return -1;
+
+	memcpy(&magic, rec + sizeof(struct sys_log_bin_hdr), sizeof(magic));
+	memcpy(&version, rec + sizeof(struct sys_log_bin_hdr) + 4U,
+	       sizeof(version));
+
+	if ((magic != SYS_LOG_BIN_MAGIC) || (version != SYS_LOG_BIN_VERSION)) {
+		fprintf(stderr, "Unsupported log (magic 0x%08x, version %u)\n",
+			magic, version);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Decodes a log, only loading its format definitions if defs_only */
+static int decode_file(FILE *f, bool defs_only)
+{
+	static uint8_t rec[UINT16_MAX + 1U];
+	int err = 0;
+	struct sys_log_bin_hdr hdr;
+
+	while (fread(&hdr, sizeof(hdr), 1U, f) == 1U) {
+		if (hdr.len < sizeof(hdr)) {
+			fprintf(stderr, "Corrupted record at offset %ld\n",
+				ftell(f) - (long)sizeof(hdr));
+			err = 1;
+			break;
+		}
+
+		memcpy(rec, &hdr, sizeof(hdr));
+
+		if (fread(&rec[sizeof(hdr)], hdr.len - sizeof(hdr), 1U, f) !=
+		    1U) {
+			if (hdr.len > sizeof(hdr)) {
+				fprintf(stderr, "Truncated record at end of log\n");
+				err = 1;
+				break;
+			}
+		}
+
+		switch (hdr.type) {
+		case SYS_LOG_BIN_REC_SESSION:
+			if (decode_session(rec, hdr.len) < 0)
+				err = 1;
+			break;
+		case SYS_LOG_BIN_REC_FMT:
+			decode_fmt(rec, hdr.len);
+			break;
+		case SYS_LOG_BIN_REC_EVENT:
+			if (!defs_only)
+				decode_event(rec, hdr.len, hdr.level);
+			break;
+		case SYS_LOG_BIN_REC_TEXT:
+			if (!defs_only)
+				decode_text(rec, hdr.len, hdr.level);
+			break;
+		default:
+			fprintf(stderr, "Unknown record type 0x%02x\n",
+				hdr.type);
+			err = 1;
+			break;
+		}
+
+		if (err != 0)
+			break;
+	}
+
+	return err;
+}
+
+static FILE *open_log(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+
+	if (f == NULL)
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+
+	return f;
+}
+
+int main(int argc, char **argv)
+{
+	FILE *f = stdin;
+	int err = 0;
+	int arg = 1;
+
+	/*
+	 * Records without their FMT records, e.g. from the flight recorder,
+	 * take the definitions from the log file of the same run.
+	 */
+	if ((argc > 2) && (strcmp(argv[1], "-f") == 0)) {
+		FILE *defs_f = open_log(argv[2]);
+
+		if (defs_f == NULL)
+			return 1;
+
+		err = decode_file(defs_f, true);
+		fclose(defs_f);
+
+		if (err != 0)
+			return err;
+
+		arg = 3;
+	}
+
+	if (argc > (arg + 1)) {
+		fprintf(stderr, "Usage: %s [-f definitions log] [log file]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (argc == (arg + 1)) {
+		f = open_log(argv[arg]);
+
+		if (f == NULL)
+			return 1;
+	}
+
+	err = decode_file(f, false);
+
+	if (f != stdin)
+		fclose(f);
+
+	return err;
+}
@@ -0,0 +1,126 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <system/sys_log_rec.h>
+
+/*
+ * Prints the entries of a sys_log flight recorder file, oldest first. Works
+ * on the file of a running process as well as on one left by a crash.
+ * Entries recorded in binary form are written as they are, to be rendered
+ * with obdh2-log-decode -f <log file of the same run>.
+ */
+
+static int dump(const struct sys_log_rec_hdr *hdr, size_t size,
+		uint64_t count)
+{
+	const struct sys_log_rec_slot *slots =
+		(const void *)((const char *)hdr + hdr->hdr_size);
+	uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	uint64_t first = (head > hdr->slots) ? (head - hdr->slots) : 0U;
+	uint64_t skipped = 0U;
+
+	if ((hdr->hdr_size + ((size_t)hdr->slots * hdr->slot_size)) > size) {
+		fprintf(stderr, "Recorder file is truncated\n");
+		return -1;
+	}
+
+	if ((count > 0U) && ((head - first) > count))
+		first = head - count;
+
+	for (uint64_t i = first; i < head; ++i) {
+		const struct sys_log_rec_slot *s = &slots[i % hdr->slots];
+		char line[SYS_LOG_REC_DATA_MAX];
+		uint32_t len;
+
+		if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != (i + 1U)) {
+			skipped++;
+			continue;
+		}
+
+		len = s->len;
+
+		if (len > sizeof(line))
+			len = sizeof(line);
+
+		memcpy(line, s->data, len);
+
+		/* The entry may have been overwritten while it was copied */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != (i + 1U)) {
+			skipped++;
+			continue;
+		}
+
+		fwrite(line, 1U, len, stdout);
+	}
+
+	if (skipped > 0U)
+		fprintf(stderr, "%lu incomplete entries skipped\n",
+			(unsigned long)skipped);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t count = 0U;
+
+	if ((argc < 2) || (argc > 3)) {
+		fprintf(stderr, "Usage: %s <recorder file> [last N entries]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (argc == 3)
+		count = strtoull(argv[2], NULL, 0);
+
+	int fd = open(argv[1], O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	struct stat st;
+
+	if ((fstat(fd, &st) < 0) ||
+	    ((size_t)st.st_size < sizeof(struct sys_log_rec_hdr))) {
+		fprintf(stderr, "%s: not a recorder file\n", argv[1]);
+		close(fd);
+		return 1;
+	}
+
+	const struct sys_log_rec_hdr *hdr =
+		mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (hdr == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	int err = 0;
+
+	if ((hdr->magic != SYS_LOG_REC_MAGIC) ||
+	    (hdr->version != SYS_LOG_REC_VERSION) ||
+	    (hdr->slot_size != sizeof(struct sys_log_rec_slot)) ||
+	    (hdr->slots == 0U)) {
+		fprintf(stderr, "%s: unsupported recorder file\n", argv[1]);
+		err = 1;
+	} else if (dump(hdr, st.st_size, count) < 0) {
+		err = 1;
+	}
+
+	munmap((void *)hdr, st.st_size);
+
+	return err;
+}
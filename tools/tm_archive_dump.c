@@ -0,0 +1,340 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <system/tm_archive.h>
+
+/*
+ * Prints the samples of a telemetry archive file, one line per sample, or
+ * only the values of one field of a series. A single field is decoded
+ * without touching the other columns of the blocks.
+ */
+
+#define SCHEMAS_MAX 8U
+
+#define FIELDS_MAX UINT8_MAX
+
+struct schema {
+	uint8_t type;
+	uint8_t instance;
+	uint8_t nfields;
+	const char *names[FIELDS_MAX];
+	uint8_t lens[FIELDS_MAX];
+};
+
+static struct schema schemas[SCHEMAS_MAX];
+
+static unsigned int nschemas;
+
+static const char *const type_names[TM_PUB_TYPE_COUNT] = {
+	[TM_PUB_EPS_DATA] = "eps",
+	[TM_PUB_TTC_DATA] = "ttc",
+	[TM_PUB_EDC_HK] = "edc",
+};
+
+static struct {
+	int type; /* -1 for every series */
+	int instance; /* -1 for every instance */
+	const char *field; /* NULL for every field */
+} filter = { -1, -1, NULL };
+
+static struct {
+	unsigned long blocks;
+	unsigned long samples;
+	unsigned long values;
+} totals;
+
+static struct schema *schema_get(uint8_t type, uint8_t instance)
+{
+	for (unsigned int i = 0U; i < nschemas; ++i) {
+		if ((schemas[i].type == type) &&
+		    (schemas[i].instance == instance))
+			return &schemas[i];
+	}
+
+	if (nschemas == SCHEMAS_MAX)
+		return NULL;
+
+	schemas[nschemas].type = type;
+	schemas[nschemas].instance = instance;
+
+	return &schemas[nschemas++];
+}
+
+static const char *type_name(uint8_t type)
+{
+	if ((type < TM_PUB_TYPE_COUNT) && (type_names[type] != NULL))
+		return type_names[type];
+
+	return "?";
+}
+
+static int read_schema(const struct tm_archive_rec_hdr *hdr,
+		       const uint8_t *p, const uint8_t *end)
+{
+	struct schema *s = schema_get(hdr->type, hdr->instance);
+
+	if (s == NULL)
+		return -1;
+
+	s->nfields = 0U;
+
+	for (uint8_t f = 0U; f < hdr->nfields; ++f) {
+		if (((end - p) < 2) || ((end - p - 2) < p[1]))
+			return -1;
+
+		s->lens[f] = p[1];
+		s->names[f] = (const char *)&p[2];
+		p += 2U + p[1];
+	}
+
+	s->nfields = hdr->nfields;
+
+	return 0;
+}
+
+/* Decodes count zigzag varints, undoing one (delta) or two levels */
+static int read_column(const uint8_t *p, const uint8_t *end, uint32_t count,
+		       int64_t base, bool dod, int64_t *out)
+{
+	int64_t prev = base;
+	int64_t delta = 0;
+
+	for (uint32_t i = 0U; i < count; ++i) {
+		uint64_t v;
+		size_t n = tm_archive_get_varint(p, end, &v);
+
+		if (n == 0U)
+			return -1;
+
+		p += n;
+
+		if (dod) {
+			delta += tm_archive_unzigzag(v);
+			prev += delta;
+		} else {
+			prev += tm_archive_unzigzag(v);
+		}
+
+		out[i] = prev;
+	}
+
+	return 0;
+}
+
+static int read_block(const struct tm_archive_rec_hdr *hdr, const uint8_t *p,
+		      const uint8_t *end)
+{
+	static int64_t cols[FIELDS_MAX][TM_ARCHIVE_BLOCK_SAMPLES];
+	int64_t ts[TM_ARCHIVE_BLOCK_SAMPLES];
+	const uint8_t *rec = (const uint8_t *)hdr;
+	const struct schema *s = schema_get(hdr->type, hdr->instance);
+	size_t index_len = ((size_t)hdr->nfields + 1U) * sizeof(uint32_t);
+	uint32_t offsets[FIELDS_MAX + 1U];
+	uint32_t count;
+	uint64_t first;
+
+	if ((s == NULL) || (s->nfields != hdr->nfields) ||
+	    ((size_t)(end - p) < (20U + index_len)))
+		return -1;
+
+	memcpy(&count, p, sizeof(count));
+	memcpy(&first, &p[4], sizeof(first));
+	end -= index_len;
+	memcpy(offsets, end, index_len);
+
+	if (count > TM_ARCHIVE_BLOCK_SAMPLES)
+		return -1;
+
+	for (uint8_t f = 0U; f <= hdr->nfields; ++f) {
+		if ((offsets[f] < (size_t)(p + 20 - rec)) ||
+		    (offsets[f] > (size_t)(end - rec)))
+			return -1;
+	}
+
+	totals.blocks++;
+	totals.samples += count;
+	totals.values += (unsigned long)count * hdr->nfields;
+
+	if (((filter.type >= 0) && (filter.type != hdr->type)) ||
+	    ((filter.instance >= 0) && (filter.instance != hdr->instance)))
+		return 0;
+
+	if (read_column(&rec[offsets[0]], end, count, (int64_t)first, true,
+			ts) != 0)
+		return -1;
+
+	if (filter.field != NULL) {
+		size_t len = strlen(filter.field);
+
+		for (uint8_t f = 0U; f < s->nfields; ++f) {
+			if ((s->lens[f] != len) ||
+			    (memcmp(s->names[f], filter.field, len) != 0))
+				continue;
+
+			if (read_column(&rec[offsets[f + 1U]], end, count, 0,
+					false, cols[f]) != 0)
+				return -1;
+
+			for (uint32_t i = 0U; i < count; ++i)
+				printf("%lu.%06lu %lld\n",
+				       (unsigned long)(ts[i] / 1000000),
+				       (unsigned long)(ts[i] % 1000000),
+				       (long long)cols[f][i]);
+		}
+
+		return 0;
+	}
+
+	for (uint8_t f = 0U; f < s->nfields; ++f) {
+		if (read_column(&rec[offsets[f + 1U]], end, count, 0, false,
+				cols[f]) != 0)
+			return -1;
+	}
+
+	for (uint32_t i = 0U; i < count; ++i) {
+		printf("%lu.%06lu %s/%u", (unsigned long)(ts[i] / 1000000),
+		       (unsigned long)(ts[i] % 1000000), type_name(hdr->type),
+		       hdr->instance);
+
+		for (uint8_t f = 0U; f < s->nfields; ++f)
+			printf(" %.*s=%lld", s->lens[f], s->names[f],
+			       (long long)cols[f][i]);
+
+		putchar('\n');
+	}
+
+	return 0;
+}
+
+static int dump(const uint8_t *data, size_t size)
+{
+	struct tm_archive_file_hdr fhdr;
+
+	memcpy(&fhdr, data, sizeof(fhdr));
+
+	if ((fhdr.magic != TM_ARCHIVE_MAGIC) ||
+	    (fhdr.version != TM_ARCHIVE_VERSION) ||
+	    (fhdr.hdr_size < sizeof(fhdr)) || (fhdr.hdr_size > size)) {
+		fprintf(stderr, "Unsupported archive file\n");
+		return -1;
+	}
+
+	size_t off = fhdr.hdr_size;
+
+	while ((size - off) >= sizeof(struct tm_archive_rec_hdr)) {
+		struct tm_archive_rec_hdr hdr;
+		struct tm_archive_rec_end tail;
+
+		memcpy(&hdr, &data[off], sizeof(hdr));
+
+		if ((hdr.len < (sizeof(hdr) + sizeof(tail))) ||
+		    (hdr.len > (size - off)))
+			break;
+
+		memcpy(&tail, &data[off + hdr.len - sizeof(tail)], sizeof(tail));
+
+		if ((tail.len != hdr.len) || (tail.magic != TM_ARCHIVE_REC_MAGIC))
+			break;
+
+		const uint8_t *body = &data[off + sizeof(hdr)];
+		const uint8_t *end = &data[off + hdr.len - sizeof(tail)];
+		int err = 0;
+
+		if (hdr.rec == TM_ARCHIVE_REC_SCHEMA)
+			err = read_schema(&hdr, body, end);
+		else if (hdr.rec == TM_ARCHIVE_REC_BLOCK)
+			err = read_block((const void *)&data[off], body, end);
+
+		if (err != 0) {
+			fprintf(stderr, "Bad record at offset %lu\n",
+				(unsigned long)off);
+			return -1;
+		}
+
+		off += hdr.len;
+	}
+
+	if (off < size)
+		fprintf(stderr, "%lu bytes of a torn record skipped\n",
+			(unsigned long)(size - off));
+
+	fprintf(stderr,
+		"%lu blocks, %lu samples, %lu values in %lu bytes (%.2f bytes per value)\n",
+		totals.blocks, totals.samples, totals.values,
+		(unsigned long)size,
+		(totals.values > 0U) ? ((double)size / (double)totals.values) :
+				       0.0);
+
+	return 0;
+}
+
+static int parse_series(const char *arg)
+{
+	const char *slash = strchr(arg, '/');
+	size_t len = (slash != NULL) ? (size_t)(slash - arg) : strlen(arg);
+
+	for (int t = 0; t < (int)TM_PUB_TYPE_COUNT; ++t) {
+		if ((type_names[t] != NULL) && (strlen(type_names[t]) == len) &&
+		    (strncmp(type_names[t], arg, len) == 0))
+			filter.type = t;
+	}
+
+	if (slash != NULL)
+		filter.instance = atoi(slash + 1);
+
+	return (filter.type >= 0) ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+	if ((argc < 2) || (argc > 4) ||
+	    ((argc > 2) && (parse_series(argv[2]) != 0))) {
+		fprintf(stderr,
+			"Usage: %s <archive file> [eps|ttc|edc[/instance] [field]]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (argc == 4)
+		filter.field = argv[3];
+
+	int fd = open(argv[1], O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	struct stat st;
+
+	if ((fstat(fd, &st) < 0) ||
+	    ((size_t)st.st_size < sizeof(struct tm_archive_file_hdr))) {
+		fprintf(stderr, "%s: not an archive file\n", argv[1]);
+		close(fd);
+		return 1;
+	}
+
+	const uint8_t *data =
+		mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	int err = (dump(data, st.st_size) < 0) ? 1 : 0;
+
+	munmap((void *)data, st.st_size);
+
+	return err;
+}